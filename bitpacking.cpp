@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <stdint.h>
+
+#include "bitpacking.h"
+
+namespace SerialDV
+{
+
+// 8 bytes with the first byte in the least significant position
+static inline uint64_t loadBytes(const unsigned char *p)
+{
+    uint64_t x;
+    ::memcpy(&x, p, 8);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    x = __builtin_bswap64(x);
+#endif
+    return x;
+}
+
+static inline void storeBytes(unsigned char *p, uint64_t x)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    x = __builtin_bswap64(x);
+#endif
+    ::memcpy(p, &x, 8);
+}
+
+static inline unsigned char pack8(const unsigned char *bits)
+{
+    uint64_t x = loadBytes(bits);
+    // bit 0 of byte i lands at bit 63 - i, the other products fall outside the top byte
+    return (unsigned char) (((x & 0x0101010101010101ULL) * 0x8040201008040201ULL) >> 56);
+}
+
+static inline void unpack8(unsigned char byte, unsigned char *bits)
+{
+    // byte i keeps bit 7 - i of its copy then is set to 1 if not zero
+    uint64_t x = (byte * 0x0101010101010101ULL) & 0x0102040810204080ULL;
+    storeBytes(bits, ((x + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL);
+}
+
+void BitPacking::packBits(const unsigned char *bits, unsigned char *bytes, unsigned int nbBits)
+{
+    unsigned int nbFull = nbBits / 8;
+
+    for (unsigned int i = 0; i < nbFull; i++) {
+        bytes[i] = pack8(bits + 8*i);
+    }
+
+    unsigned int nbLeft = nbBits % 8;
+
+    if (nbLeft != 0)
+    {
+        unsigned char byte = 0;
+
+        for (unsigned int i = 0; i < nbLeft; i++) {
+            byte |= (bits[8*nbFull + i] & 1) << (7 - i);
+        }
+
+        bytes[nbFull] = byte;
+    }
+}
+
+void BitPacking::unpackBits(const unsigned char *bytes, unsigned char *bits, unsigned int nbBits)
+{
+    unsigned int nbFull = nbBits / 8;
+
+    for (unsigned int i = 0; i < nbFull; i++) {
+        unpack8(bytes[i], bits + 8*i);
+    }
+
+    for (unsigned int i = 0; i < nbBits % 8; i++) {
+        bits[8*nbFull + i] = (bytes[nbFull] >> (7 - i)) & 1;
+    }
+}
+
+bool BitPacking::pack(DVRate rate, const unsigned char *bits, unsigned char *mbeFrames, unsigned int nbFrames)
+{
+    unsigned int nbBits = DVController::getNbMbeBits(rate);
+    unsigned int nbBytes = DVController::getNbMbeBytes(rate);
+
+    if (nbBits == 0) {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < nbFrames; i++) {
+        packBits(bits + i*nbBits, mbeFrames + i*nbBytes, nbBits);
+    }
+
+    return true;
+}
+
+bool BitPacking::unpack(DVRate rate, const unsigned char *mbeFrames, unsigned char *bits, unsigned int nbFrames)
+{
+    unsigned int nbBits = DVController::getNbMbeBits(rate);
+    unsigned int nbBytes = DVController::getNbMbeBytes(rate);
+
+    if (nbBits == 0) {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < nbFrames; i++) {
+        unpackBits(mbeFrames + i*nbBytes, bits + i*nbBits, nbBits);
+    }
+
+    return true;
+}
+
+} // namespace SerialDV
@@ -0,0 +1,47 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef BITPACKING_H_
+#define BITPACKING_H_
+
+#include "serialdv_export.h"
+#include "dvcontroller.h"
+
+namespace SerialDV
+{
+
+/** Conversions between bit arrays of one bit per byte (as output by demodulators, only the
+ * least significant bit of each byte is used) and the MBE frame bytes of encode() and decode().
+ * Bits are packed most significant bit first and the unused bits of the last byte are zero.
+ *
+ * 8 bits are gathered or spread at once with a 64 bit multiply.
+ */
+class SERIALDV_API BitPacking
+{
+public:
+    static void packBits(const unsigned char *bits, unsigned char *bytes, unsigned int nbBits);
+    static void unpackBits(const unsigned char *bytes, unsigned char *bits, unsigned int nbBits);
+
+    /** Pack nbFrames consecutive frames of getNbMbeBits(rate) bits into nbFrames consecutive
+     * frames of getNbMbeBytes(rate) bytes. Returns false if the rate is not mapped.
+     */
+    static bool pack(DVRate rate, const unsigned char *bits, unsigned char *mbeFrames, unsigned int nbFrames = 1);
+    static bool unpack(DVRate rate, const unsigned char *mbeFrames, unsigned char *bits, unsigned int nbFrames = 1);
+};
+
+} // namespace SerialDV
+
+#endif /* BITPACKING_H_ */
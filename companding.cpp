@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cassert>
+
+#include "companding.h"
+
+namespace SerialDV
+{
+
+namespace
+{
+
+struct DecodeTables
+{
+    short uLaw[256];
+    short aLaw[256];
+
+    DecodeTables()
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            int u = ~i & 0xFF;
+            int t = (((u & 0x0F) << 3) + 0x84) << ((u & 0x70) >> 4);
+            uLaw[i] = (u & 0x80) ? (0x84 - t) : (t - 0x84);
+
+            int a = i ^ 0x55;
+            int seg = (a & 0x70) >> 4;
+            t = (a & 0x0F) << 4;
+            t = seg == 0 ? t + 8 : (t + 0x108) << (seg - 1);
+            aLaw[i] = (a & 0x80) ? t : -t;
+        }
+    }
+};
+
+const DecodeTables& decodeTables()
+{
+    static const DecodeTables tables;
+    return tables;
+}
+
+/** x >> shift for shift in [0,7] with constant shifts and selects only.
+ * SSE2 has no per lane variable shift so a plain x >> shift keeps the loops scalar.
+ */
+inline int shiftRight(int x, int shift)
+{
+    x = (shift & 1) ? x >> 1 : x;
+    x = (shift & 2) ? x >> 2 : x;
+    return (shift & 4) ? x >> 4 : x;
+}
+
+} // anonymous namespace
+
+void Companding::linearToULaw(const short *in, unsigned char *out, unsigned int nbSamples)
+{
+    assert(in != 0);
+    assert(out != 0);
+
+    for (unsigned int i = 0; i < nbSamples; i++)
+    {
+        int x = in[i] >> 2; // 14 bit
+        int mask = x < 0 ? 0x7F : 0xFF;
+        x = x < 0 ? -x : x;
+        x = x > 8158 ? 8158 : x; // 8158 + bias is the top of the last segment
+        x += 0x21; // bias
+        int seg = (x > 0x3F) + (x > 0x7F) + (x > 0xFF) + (x > 0x1FF)
+                + (x > 0x3FF) + (x > 0x7FF) + (x > 0xFFF);
+        out[i] = ((seg << 4) | (shiftRight(x >> 1, seg) & 0x0F)) ^ mask;
+    }
+}
+
+void Companding::uLawToLinear(const unsigned char *in, short *out, unsigned int nbSamples)
+{
+    assert(in != 0);
+    assert(out != 0);
+    const short *table = decodeTables().uLaw;
+
+    for (unsigned int i = 0; i < nbSamples; i++) {
+        out[i] = table[in[i]];
+    }
+}
+
+void Companding::linearToALaw(const short *in, unsigned char *out, unsigned int nbSamples)
+{
+    assert(in != 0);
+    assert(out != 0);
+
+    for (unsigned int i = 0; i < nbSamples; i++)
+    {
+        int x = in[i] >> 3; // 13 bit
+        int mask = x < 0 ? 0x55 : 0xD5;
+        x = x < 0 ? -x - 1 : x;
+        int seg = (x > 0x1F) + (x > 0x3F) + (x > 0x7F) + (x > 0xFF)
+                + (x > 0x1FF) + (x > 0x3FF) + (x > 0x7FF);
+        out[i] = ((seg << 4) | (shiftRight(x, seg < 2 ? 1 : seg) & 0x0F)) ^ mask;
+    }
+}
+
+void Companding::aLawToLinear(const unsigned char *in, short *out, unsigned int nbSamples)
+{
+    assert(in != 0);
+    assert(out != 0);
+    const short *table = decodeTables().aLaw;
+
+    for (unsigned int i = 0; i < nbSamples; i++) {
+        out[i] = table[in[i]];
+    }
+}
+
+} // namespace SerialDV
@@ -0,0 +1,48 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef COMPANDING_H_
+#define COMPANDING_H_
+
+#include "serialdv_export.h"
+
+namespace SerialDV
+{
+
+typedef enum
+{
+    DVCompandingNone,  //!< 16 bit linear samples
+    DVCompandingULaw,  //!< G.711 µ-law 8 bit samples
+    DVCompandingALaw   //!< G.711 A-law 8 bit samples
+} DVCompanding;
+
+/** G.711 conversions between 16 bit linear samples and 8 bit companded samples.
+ * Encoders compute the segment with comparisons and the mantissa with constant shifts
+ * instead of a search loop and a variable shift so that the compiler vectorizes them
+ * with the default flags (SSE2 on x86-64). Decoders use a 256 entries lookup table.
+ */
+class SERIALDV_API Companding
+{
+public:
+    static void linearToULaw(const short *in, unsigned char *out, unsigned int nbSamples);
+    static void uLawToLinear(const unsigned char *in, short *out, unsigned int nbSamples);
+    static void linearToALaw(const short *in, unsigned char *out, unsigned int nbSamples);
+    static void aLawToLinear(const unsigned char *in, short *out, unsigned int nbSamples);
+};
+
+} // namespace SerialDV
+
+#endif /* COMPANDING_H_ */
@@ -0,0 +1,161 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+
+#include "conference.h"
+
+namespace SerialDV
+{
+
+Conference::Conference(DVController& controller) :
+    m_controller(controller),
+    m_nextSubscriptionId(0),
+    m_nbDecoded(0)
+{}
+
+Conference::~Conference()
+{}
+
+void Conference::addTalker(int talkerId, DVRate rate, int gain)
+{
+    Talker& talker = m_talkers[talkerId];
+    talker.rate = rate;
+    talker.gain = gain;
+}
+
+void Conference::removeTalker(int talkerId)
+{
+    m_talkers.erase(talkerId);
+}
+
+int Conference::subscribe(FrameCallback callback)
+{
+    int subscriptionId = m_nextSubscriptionId++;
+    m_subscribers[subscriptionId] = callback;
+    return subscriptionId;
+}
+
+void Conference::unsubscribe(int subscriptionId)
+{
+    m_subscribers.erase(subscriptionId);
+}
+
+std::shared_ptr<PCMFrame> Conference::allocateFrame()
+{
+    for (unsigned int i = 0; i < m_pool.size(); i++)
+    {
+        if (m_pool[i].use_count() == 1) { // only held by the pool
+            return m_pool[i];
+        }
+    }
+
+    m_pool.push_back(std::make_shared<PCMFrame>());
+    return m_pool.back();
+}
+
+bool Conference::decodeFrame(int talkerId, const unsigned char *mbeFrame)
+{
+    std::map<int, Talker>::const_iterator it = m_talkers.find(talkerId);
+
+    if (it == m_talkers.end()) {
+        return false;
+    }
+
+    std::shared_ptr<PCMFrame> frame = allocateFrame();
+    frame->talkerId = talkerId;
+
+    if (!m_controller.decode(frame->samples, mbeFrame, it->second.rate, it->second.gain)) {
+        return false;
+    }
+
+    m_nbDecoded++;
+    PCMFrameRef ref = frame;
+    m_frames.push_back(ref);
+
+    for (std::map<int, FrameCallback>::const_iterator sub = m_subscribers.begin(); sub != m_subscribers.end(); ++sub) {
+        sub->second(ref);
+    }
+
+    return true;
+}
+
+unsigned int Conference::mix(int listenerId, short *audioFrame) const
+{
+    const short *frames[32];
+    unsigned int nbFrames = 0;
+    unsigned int nbTalkers = 0;
+
+    for (unsigned int i = 0; i < m_frames.size(); i++)
+    {
+        if (m_frames[i]->talkerId == listenerId) {
+            continue;
+        }
+
+        frames[nbFrames++] = m_frames[i]->samples;
+        nbTalkers++;
+
+        if (nbFrames == sizeof(frames) / sizeof(frames[0])) // mix in batches
+        {
+            mixFrames(frames, nbFrames, audioFrame);
+            frames[0] = audioFrame;
+            nbFrames = 1;
+        }
+    }
+
+    mixFrames(frames, nbFrames, audioFrame);
+    return nbTalkers;
+}
+
+void Conference::nextPeriod()
+{
+    m_frames.clear();
+}
+
+void Conference::mixFrames(const short * const *frames, unsigned int nbFrames, short *audioFrame)
+{
+    if (nbFrames == 0)
+    {
+        memset(audioFrame, 0, MBE_AUDIO_BLOCK_BYTES);
+        return;
+    }
+
+    // 32 bit accumulation then clamping: both loops are vectorized by the compiler
+    int sum[MBE_AUDIO_BLOCK_SIZE];
+
+    for (unsigned int i = 0; i < MBE_AUDIO_BLOCK_SIZE; i++) {
+        sum[i] = frames[0][i];
+    }
+
+    for (unsigned int f = 1; f < nbFrames; f++)
+    {
+        const short *frame = frames[f];
+
+        for (unsigned int i = 0; i < MBE_AUDIO_BLOCK_SIZE; i++) {
+            sum[i] += frame[i];
+        }
+    }
+
+    for (unsigned int i = 0; i < MBE_AUDIO_BLOCK_SIZE; i++)
+    {
+        int sample = sum[i];
+        sample = sample > 32767 ? 32767 : sample;
+        sample = sample < -32768 ? -32768 : sample;
+        audioFrame[i] = sample;
+    }
+}
+
+} // namespace SerialDV
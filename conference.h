@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CONFERENCE_H_
+#define CONFERENCE_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "serialdv_export.h"
+#include "dvcontroller.h"
+
+namespace SerialDV
+{
+
+/** One decoded audio frame shared by all the subscribers of a talker
+ */
+struct PCMFrame
+{
+    int talkerId;
+    short samples[MBE_AUDIO_BLOCK_SIZE];
+};
+
+typedef std::shared_ptr<const PCMFrame> PCMFrameRef;
+
+/** Talkgroup bridge: each AMBE frame of a talker is decoded once and the resulting
+ * reference counted PCM frame is handed to every subscriber. Listeners get the mix of
+ * the other talkers of the current frame period (mix-minus) so that device load scales
+ * with the number of talkers and not with talkers times listeners.
+ *
+ * Usage per 20 ms period: decodeFrame() for each talker with a frame, then mix() for each
+ * listener, then nextPeriod(). Not thread safe.
+ */
+class SERIALDV_API Conference
+{
+public:
+    typedef std::function<void(const PCMFrameRef& frame)> FrameCallback;
+
+    explicit Conference(DVController& controller);
+    ~Conference();
+
+    void addTalker(int talkerId, DVRate rate, int gain = 0);
+    void removeTalker(int talkerId);
+
+    /** Subscribe to all decoded frames. Returns the subscription id
+     */
+    int subscribe(FrameCallback callback);
+    void unsubscribe(int subscriptionId);
+
+    /** Decode the AMBE frame of a talker and deliver it to the subscribers
+     */
+    bool decodeFrame(int talkerId, const unsigned char *mbeFrame);
+
+    /** Mix of the frames of the current period of all talkers except the listener itself.
+     * A listener that is not a talker gets all talkers. Returns the number of talkers mixed.
+     */
+    unsigned int mix(int listenerId, short *audioFrame) const;
+
+    /** Release the frames of the current period
+     */
+    void nextPeriod();
+
+    const std::vector<PCMFrameRef>& getFrames() const { return m_frames; }
+    unsigned long long getNbDecoded() const { return m_nbDecoded; }
+
+    /** Saturating sum of nbFrames audio frames of MBE_AUDIO_BLOCK_SIZE samples
+     */
+    static void mixFrames(const short * const *frames, unsigned int nbFrames, short *audioFrame);
+
+private:
+    struct Talker
+    {
+        DVRate rate;
+        int gain;
+    };
+
+    DVController& m_controller;
+    std::map<int, Talker> m_talkers;
+    std::map<int, FrameCallback> m_subscribers;
+    int m_nextSubscriptionId;
+    std::vector<PCMFrameRef> m_frames;                //!< frames of the current period
+    std::vector<std::shared_ptr<PCMFrame>> m_pool;    //!< frames reused once no subscriber holds them
+    unsigned long long m_nbDecoded;
+
+    std::shared_ptr<PCMFrame> allocateFrame();
+};
+
+} // namespace SerialDV
+
+#endif /* CONFERENCE_H_ */
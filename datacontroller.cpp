@@ -15,14 +15,34 @@
 ///////////////////////////////////////////////////////////////////////////////////
 
 #include "datacontroller.h"
+#include "tracering.h"
+#include "packetframer.h"
 
 namespace SerialDV
 {
 
-DataController::DataController()
+DataController::DataController() :
+    m_trace(nullptr)
 {}
 
 DataController::~DataController()
 {}
 
+int DataController::readPacket(PacketView& packet, unsigned int timeoutUs)
+{
+    return readFramedPacket(*this, packet, timeoutUs);
+}
+
+int DataController::writePacket(const unsigned char* packet, unsigned int length)
+{
+    return write(packet, length);
+}
+
+void DataController::traceWrite(const unsigned char* buffer, int length)
+{
+    if (m_trace) {
+        m_trace->recordPacket(length < 0 ? TraceError : TraceWrite, buffer, length < 0 ? 0 : length);
+    }
+}
+
 } // namespace SerialDV
\ No newline at end of file
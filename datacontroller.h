@@ -41,8 +41,24 @@ enum SERIAL_SPEED {
     SERIAL_460800 = 460800
 };
 
+class TraceRing;
+
+/** Complete AMBE3000 packet (header included) held by the transport
+ */
+struct PacketView
+{
+    const unsigned char *data;
+    unsigned int length;
+};
+
 class SERIALDV_API DataController {
 public:
+#ifdef __WINDOWS__
+    static const unsigned int BUFFER_LENGTH = 1000U;
+#else
+    static const unsigned int BUFFER_LENGTH = 400U;
+#endif
+
     DataController();
     virtual ~DataController();
 
@@ -54,11 +70,31 @@ public:
 
     virtual void closeIt() = 0;
 
-#ifdef __WINDOWS__
-    static const unsigned int BUFFER_LENGTH = 1000U;
-#else
-    static const unsigned int BUFFER_LENGTH = 400U;
-#endif
+    /** Read one complete packet. The view is valid until the next read. Returns the packet length,
+     * 0 on timeout or -1 on error. By default the packet is framed from the byte stream given by
+     * initResponse() and read(). Datagram transports hand over their receive buffer.
+     */
+    virtual int readPacket(PacketView& packet, unsigned int timeoutUs);
+    /** Write one complete packet
+     */
+    virtual int writePacket(const unsigned char* packet, unsigned int length);
+    /** True when each write is sent as one datagram: packets must then be written one at a time
+     */
+    virtual bool isDatagram() const { return false; }
+
+    /** Record writes to the trace ring. nullptr disables tracing
+     */
+    void setTrace(TraceRing *trace) { m_trace = trace; }
+
+protected:
+    TraceRing *m_trace;
+    unsigned char m_packetBuffer[BUFFER_LENGTH];
+
+    void traceWrite(const unsigned char* buffer, int length);
+    /** Stream framing parser. Templated on the transport so that exact transport types get direct calls (see packetframer.h)
+     */
+    template<class Stream>
+    int readFramedPacket(Stream& stream, PacketView& packet, unsigned int timeoutUs);
 };
 
 } // namespace SerialDV
@@ -0,0 +1,219 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <cassert>
+#include <stdint.h>
+
+#include "decodecache.h"
+
+namespace SerialDV
+{
+
+bool DecodeCache::Key::operator==(const Key& other) const
+{
+    return (rate == other.rate)
+        && (gain == other.gain)
+        && (nbBytes == other.nbBytes)
+        && (::memcmp(bytes, other.bytes, nbBytes) == 0);
+}
+
+size_t DecodeCache::hash(const Key& key)
+{
+    // FNV-1a
+    uint32_t h = 2166136261U;
+    h = (h ^ (uint32_t) key.rate) * 16777619U;
+    h = (h ^ (uint32_t) key.gain) * 16777619U;
+
+    for (unsigned int i = 0; i < key.nbBytes; i++) {
+        h = (h ^ key.bytes[i]) * 16777619U;
+    }
+
+    return h;
+}
+
+DecodeCache::DecodeCache(unsigned int maxEntries) :
+        m_maxEntries(maxEntries),
+        m_pool(maxEntries),
+        m_buckets(maxEntries < 1 ? 1 : 2*maxEntries),
+        m_lastValid(false)
+{
+    clear();
+}
+
+DecodeCache::~DecodeCache()
+{
+}
+
+bool DecodeCache::makeKey(DVRate rate, int gain, const unsigned char *mbeFrame, Key& key)
+{
+    key.nbBytes = DVController::getNbMbeBytes(rate);
+
+    if ((key.nbBytes == 0) || (key.nbBytes > MBE_FRAME_MAX_LENGTH_BYTES_INTERNAL)) {
+        return false;
+    }
+
+    key.rate = rate;
+    key.gain = gain;
+    ::memcpy(key.bytes, mbeFrame, key.nbBytes);
+    return true;
+}
+
+int DecodeCache::find(const Key& key, unsigned int bucket) const
+{
+    int index = m_buckets[bucket];
+
+    while ((index >= 0) && !(m_pool[index].key == key)) {
+        index = m_pool[index].next;
+    }
+
+    return index;
+}
+
+void DecodeCache::removeFromBucket(int index)
+{
+    int *link = &m_buckets[hash(m_pool[index].key) % m_buckets.size()];
+
+    while (*link != index) {
+        link = &m_pool[*link].next;
+    }
+
+    *link = m_pool[index].next;
+}
+
+void DecodeCache::lruUnlink(int index)
+{
+    Entry& entry = m_pool[index];
+
+    if (entry.lruPrev >= 0) {
+        m_pool[entry.lruPrev].lruNext = entry.lruNext;
+    } else {
+        m_lruHead = entry.lruNext;
+    }
+
+    if (entry.lruNext >= 0) {
+        m_pool[entry.lruNext].lruPrev = entry.lruPrev;
+    } else {
+        m_lruTail = entry.lruPrev;
+    }
+}
+
+void DecodeCache::lruPushFront(int index)
+{
+    Entry& entry = m_pool[index];
+    entry.lruPrev = -1;
+    entry.lruNext = m_lruHead;
+
+    if (m_lruHead >= 0) {
+        m_pool[m_lruHead].lruPrev = index;
+    } else {
+        m_lruTail = index;
+    }
+
+    m_lruHead = index;
+}
+
+bool DecodeCache::lookup(DVRate rate, int gain, const unsigned char *mbeFrame, short *audioFrame)
+{
+    assert(mbeFrame != 0);
+    assert(audioFrame != 0);
+    Key key;
+
+    if (!makeKey(rate, gain, mbeFrame, key)) {
+        return false;
+    }
+
+    int index = find(key, hash(key) % m_buckets.size());
+
+    if (index < 0)
+    {
+        m_misses++;
+        return false;
+    }
+
+    lruUnlink(index);
+    lruPushFront(index);
+    ::memcpy(audioFrame, m_pool[index].audio, MBE_AUDIO_BLOCK_BYTES);
+    m_hits++;
+    return true;
+}
+
+void DecodeCache::store(DVRate rate, int gain, const unsigned char *mbeFrame, const short *audioFrame)
+{
+    assert(mbeFrame != 0);
+    assert(audioFrame != 0);
+    Key key;
+
+    if ((m_maxEntries == 0) || !makeKey(rate, gain, mbeFrame, key)) {
+        return;
+    }
+
+    bool settled = m_lastValid
+        && (key == m_lastKey)
+        && (::memcmp(audioFrame, m_lastAudio, MBE_AUDIO_BLOCK_BYTES) == 0);
+
+    m_lastKey = key;
+    ::memcpy(m_lastAudio, audioFrame, MBE_AUDIO_BLOCK_BYTES);
+    m_lastValid = true;
+    unsigned int bucket = hash(key) % m_buckets.size();
+
+    if (!settled || (find(key, bucket) >= 0)) {
+        return;
+    }
+
+    int index;
+
+    if (m_free >= 0)
+    {
+        index = m_free;
+        m_free = m_pool[index].next;
+        m_size++;
+    }
+    else
+    {
+        index = m_lruTail; // evict the least recently used
+        lruUnlink(index);
+        removeFromBucket(index);
+    }
+
+    Entry& entry = m_pool[index];
+    entry.key = key;
+    ::memcpy(entry.audio, audioFrame, MBE_AUDIO_BLOCK_BYTES);
+    entry.next = m_buckets[bucket];
+    m_buckets[bucket] = index;
+    lruPushFront(index);
+}
+
+void DecodeCache::clear()
+{
+    for (unsigned int i = 0; i < m_buckets.size(); i++) {
+        m_buckets[i] = -1;
+    }
+
+    for (unsigned int i = 0; i < m_maxEntries; i++) {
+        m_pool[i].next = i + 1 < m_maxEntries ? (int) i + 1 : -1;
+    }
+
+    m_size = 0;
+    m_free = m_maxEntries > 0 ? 0 : -1;
+    m_lruHead = -1;
+    m_lruTail = -1;
+    m_lastValid = false;
+    m_hits = 0;
+    m_misses = 0;
+}
+
+} // namespace SerialDV
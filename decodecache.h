@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DECODECACHE_H_
+#define DECODECACHE_H_
+
+#include <vector>
+
+#include "serialdv_export.h"
+#include "datacontroller.h"
+#include "dvcontroller.h"
+
+namespace SerialDV
+{
+
+/** Bounded cache of decoded audio frames keyed on rate, output gain and AMBE frame bytes.
+ * Digital voice traffic repeats the same frames a lot (silence, idle, lost frame fill)
+ * so these can be served without a device round trip.
+ *
+ * The AMBE decoder is not stateless therefore a frame is admitted only once it has been
+ * decoded twice in a row to the very same audio i.e. when the decoder has settled on it.
+ * Least recently used entries are evicted when the cache is full.
+ *
+ * All entries are allocated by the constructor so that lookup() and store() do not allocate
+ * memory (real time mode guarantees no heap allocation after open()).
+ */
+class SERIALDV_API DecodeCache
+{
+public:
+    DecodeCache(unsigned int maxEntries);
+    ~DecodeCache();
+
+    /** Look up a frame. On hit the cached audio is copied to audioFrame (MBE_AUDIO_BLOCK_SIZE samples)
+     */
+    bool lookup(DVRate rate, int gain, const unsigned char *mbeFrame, short *audioFrame);
+
+    /** Give a frame freshly decoded by the device. It is kept only if it qualifies (see above)
+     */
+    void store(DVRate rate, int gain, const unsigned char *mbeFrame, const short *audioFrame);
+
+    void clear();
+
+    unsigned int getMaxEntries() const { return m_maxEntries; }
+    unsigned int getSize() const { return m_size; }
+    unsigned long long getHits() const { return m_hits; }
+    unsigned long long getMisses() const { return m_misses; }
+
+private:
+    struct Key
+    {
+        DVRate rate;
+        int gain;
+        unsigned short nbBytes;
+        unsigned char bytes[MBE_FRAME_MAX_LENGTH_BYTES_INTERNAL];
+
+        bool operator==(const Key& other) const;
+    };
+
+    /** Pool entry. Linked by index in the LRU list and in its hash bucket or in the free list
+     */
+    struct Entry
+    {
+        Key key;
+        short audio[MBE_AUDIO_BLOCK_SIZE];
+        int lruPrev;
+        int lruNext;
+        int next;    //!< next entry of the bucket or of the free list
+    };
+
+    unsigned int m_maxEntries;
+    std::vector<Entry> m_pool;
+    std::vector<int> m_buckets;      //!< first entry of each bucket, -1 if empty
+    unsigned int m_size;
+    int m_free;                      //!< first free entry
+    int m_lruHead;                   //!< most recently used
+    int m_lruTail;                   //!< least recently used
+    Key m_lastKey;                   //!< last frame given to store()
+    short m_lastAudio[MBE_AUDIO_BLOCK_SIZE];
+    bool m_lastValid;
+    unsigned long long m_hits;
+    unsigned long long m_misses;
+
+    static size_t hash(const Key& key);
+    int find(const Key& key, unsigned int bucket) const;
+    void removeFromBucket(int index);
+    void lruUnlink(int index);
+    void lruPushFront(int index);
+    static bool makeKey(DVRate rate, int gain, const unsigned char *mbeFrame, Key& key);
+};
+
+} // namespace SerialDV
+
+#endif /* DECODECACHE_H_ */
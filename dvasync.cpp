@@ -0,0 +1,214 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <cstring>
+#include <memory>
+
+#include "dvasync.h"
+
+namespace SerialDV
+{
+
+DVAsync::DVAsync(DVController& controller, unsigned int window) :
+        m_controller(controller),
+        m_window(window > DVController::MAX_IN_FLIGHT ? DVController::MAX_IN_FLIGHT : window),
+        m_stop(false),
+        m_nbCompleted(0),
+        m_nbFailed(0),
+        m_nbSubmitted(0),
+        m_queueDelayNs(0)
+{
+}
+
+DVAsync::~DVAsync()
+{
+    stop();
+}
+
+void DVAsync::start()
+{
+    if (m_thread.joinable()) {
+        return;
+    }
+
+    m_stop = false;
+    m_thread = std::thread(&DVAsync::run, this);
+}
+
+void DVAsync::stop()
+{
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_cond.notify_one();
+    m_thread.join();
+}
+
+void DVAsync::encode(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain, Completion completion)
+{
+    assert(audioFrame != 0);
+    assert(mbeFrame != 0);
+    Request request;
+    request.encode = true;
+    request.rate = rate;
+    request.gain = gain;
+    ::memcpy(request.audioIn, audioFrame, MBE_AUDIO_BLOCK_BYTES);
+    request.mbeOut = mbeFrame;
+    request.audioOut = nullptr;
+    request.completion = completion;
+    queue(request);
+}
+
+void DVAsync::decode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain, Completion completion)
+{
+    assert(audioFrame != 0);
+    assert(mbeFrame != 0);
+    unsigned short nbBytes = DVController::getNbMbeBytes(rate);
+
+    if (nbBytes == 0)
+    {
+        completion(false);
+        return;
+    }
+
+    Request request;
+    request.encode = false;
+    request.rate = rate;
+    request.gain = gain;
+    ::memcpy(request.mbeIn, mbeFrame, nbBytes);
+    request.mbeOut = nullptr;
+    request.audioOut = audioFrame;
+    request.completion = completion;
+    queue(request);
+}
+
+std::future<bool> DVAsync::encode(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain)
+{
+    std::shared_ptr<std::promise<bool>> promise = std::make_shared<std::promise<bool>>();
+    std::future<bool> future = promise->get_future();
+    encode(audioFrame, mbeFrame, rate, gain, [promise](bool ok) { promise->set_value(ok); });
+    return future;
+}
+
+std::future<bool> DVAsync::decode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain)
+{
+    std::shared_ptr<std::promise<bool>> promise = std::make_shared<std::promise<bool>>();
+    std::future<bool> future = promise->get_future();
+    decode(audioFrame, mbeFrame, rate, gain, [promise](bool ok) { promise->set_value(ok); });
+    return future;
+}
+
+void DVAsync::queue(Request& request)
+{
+    request.queuedNs = TraceRing::now();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(std::move(request));
+    }
+
+    m_cond.notify_one();
+}
+
+unsigned int DVAsync::getNbQueued()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.size();
+}
+
+void DVAsync::run()
+{
+    std::deque<Request> inFlight; // in submission order, references stay valid while at both ends
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        while (!m_stop && m_queue.empty() && inFlight.empty()) {
+            m_cond.wait(lock);
+        }
+
+        if (m_stop) {
+            break;
+        }
+
+        unsigned int window = m_window == 0 ? m_controller.getInFlightWindow() : m_window;
+        unsigned int batch = m_window == 0 ? m_controller.getBatchSize() : 1;
+
+        // refill once a whole batch fits so that the writes of the batch go out together
+        unsigned int nbFree = inFlight.size() + batch <= window ? window - inFlight.size() : 0;
+
+        for (; (nbFree > 0) && !m_queue.empty(); nbFree--)
+        {
+            inFlight.push_back(std::move(m_queue.front()));
+            m_queue.pop_front();
+            lock.unlock();
+            Request& request = inFlight.back();
+            m_queueDelayNs += TraceRing::now() - request.queuedNs;
+            m_nbSubmitted++;
+            bool submitted = request.encode ?
+                m_controller.submitEncode(request.audioIn, request.mbeOut, request.rate, request.gain) :
+                m_controller.submitDecode(request.audioOut, request.mbeIn, request.rate, request.gain);
+
+            if (!submitted)
+            {
+                m_nbFailed++;
+                request.completion(false);
+                inFlight.pop_back();
+            }
+
+            lock.lock();
+        }
+
+        if (inFlight.empty()) {
+            continue;
+        }
+
+        lock.unlock();
+        bool ok = m_controller.collect() == 1;
+        m_nbCompleted += ok ? 1 : 0;
+        m_nbFailed += ok ? 0 : 1;
+        inFlight.front().completion(ok);
+        inFlight.pop_front();
+        lock.lock();
+    }
+
+    std::deque<Request> queued;
+    queued.swap(m_queue);
+    lock.unlock();
+
+    for (; !inFlight.empty(); inFlight.pop_front())
+    {
+        bool ok = m_controller.collect() == 1;
+        m_nbCompleted += ok ? 1 : 0;
+        m_nbFailed += ok ? 0 : 1;
+        inFlight.front().completion(ok);
+    }
+
+    for (; !queued.empty(); queued.pop_front())
+    {
+        m_nbFailed++;
+        queued.front().completion(false);
+    }
+}
+
+} // namespace SerialDV
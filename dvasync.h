@@ -0,0 +1,167 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DVASYNC_H_
+#define DVASYNC_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define SERIALDV_COROUTINES 1
+#endif
+#endif
+
+#include "serialdv_export.h"
+#include "dvcontroller.h"
+
+namespace SerialDV
+{
+
+/** Non blocking encode and decode over the pipelined path of a DVController.
+ *
+ * Requests are queued from any thread and a single I/O thread keeps up to a window of frames
+ * in flight on the device (submitEncode()/submitDecode()/collect()) so that any number of
+ * streams can be served without a thread each. With a window of 0 the window and batch size
+ * tuned by the controller from the measured round trip time are used. Completion is signalled with a callback called
+ * from the I/O thread, a std::future or, with C++20 coroutines, by resuming the awaiting
+ * coroutine in the I/O thread.
+ *
+ * Input frames are copied. Output buffers must remain valid until completion. The controller
+ * must not be used directly while the I/O thread runs.
+ */
+class SERIALDV_API DVAsync
+{
+public:
+    typedef std::function<void(bool ok)> Completion;
+
+    explicit DVAsync(DVController& controller, unsigned int window = 0);
+    ~DVAsync();
+
+    void start();
+    /** Stop the I/O thread. Frames in flight are completed, queued requests fail
+     */
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    void encode(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain, Completion completion);
+    void decode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain, Completion completion);
+    std::future<bool> encode(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain = 0);
+    std::future<bool> decode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain = 0);
+
+#ifdef SERIALDV_COROUTINES
+    /** Awaitable of one frame: bool ok = co_await async.encodeAwait(...)
+     */
+    class Awaitable
+    {
+    public:
+        Awaitable(DVAsync& async, bool encode, const short *audioIn, const unsigned char *mbeIn,
+                short *audioOut, unsigned char *mbeOut, DVRate rate, int gain) :
+            m_async(async), m_encode(encode), m_audioIn(audioIn), m_mbeIn(mbeIn),
+            m_audioOut(audioOut), m_mbeOut(mbeOut), m_rate(rate), m_gain(gain), m_result(false)
+        {}
+
+        /** decode() of an unmapped rate would complete within await_suspend(): fail without suspending
+         */
+        bool await_ready() const noexcept { return !m_encode && (DVController::getNbMbeBytes(m_rate) == 0); }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            Completion completion = [this, handle](bool ok) {
+                m_result = ok;
+                handle.resume();
+            };
+
+            if (m_encode) {
+                m_async.encode(m_audioIn, m_mbeOut, m_rate, m_gain, completion);
+            } else {
+                m_async.decode(m_audioOut, m_mbeIn, m_rate, m_gain, completion);
+            }
+        }
+
+        bool await_resume() const noexcept { return m_result; }
+
+    private:
+        DVAsync& m_async;
+        bool m_encode;
+        const short *m_audioIn;
+        const unsigned char *m_mbeIn;
+        short *m_audioOut;
+        unsigned char *m_mbeOut;
+        DVRate m_rate;
+        int m_gain;
+        bool m_result;
+    };
+
+    Awaitable encodeAwait(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain = 0)
+    {
+        return Awaitable(*this, true, audioFrame, nullptr, nullptr, mbeFrame, rate, gain);
+    }
+
+    Awaitable decodeAwait(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain = 0)
+    {
+        return Awaitable(*this, false, nullptr, mbeFrame, audioFrame, nullptr, rate, gain);
+    }
+#endif
+
+    unsigned int getNbQueued();
+    unsigned long long getNbCompleted() const { return m_nbCompleted; }
+    unsigned long long getNbFailed() const { return m_nbFailed; }
+    unsigned long long getNbSubmitted() const { return m_nbSubmitted; }
+    /** Total time requests waited in the queue before being submitted to the device
+     */
+    unsigned long long getQueueDelayUs() const { return m_queueDelayNs / 1000; }
+
+private:
+    struct Request
+    {
+        bool encode;
+        DVRate rate;
+        int gain;
+        short audioIn[MBE_AUDIO_BLOCK_SIZE];
+        unsigned char mbeIn[MBE_FRAME_MAX_LENGTH_BYTES_INTERNAL];
+        unsigned char *mbeOut;
+        short *audioOut;
+        Completion completion;
+        uint64_t queuedNs;
+    };
+
+    DVController& m_controller;
+    unsigned int m_window;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<Request> m_queue;
+    bool m_stop;
+    std::atomic<unsigned long long> m_nbCompleted;  //!< counters are written by the I/O thread
+    std::atomic<unsigned long long> m_nbFailed;
+    std::atomic<unsigned long long> m_nbSubmitted;
+    std::atomic<unsigned long long> m_queueDelayNs;
+
+    void queue(Request& request);
+    void run();
+};
+
+} // namespace SerialDV
+
+#endif /* DVASYNC_H_ */
@@ -17,9 +17,13 @@
 #include <chrono>
 #include <thread>
 #include <cassert>
+#include <cmath>
 #include <cstdio>
 #include <cstring>
+#include <map>
+#include <mutex>
 #include <stdint.h>
+#include <typeinfo>
 
 #ifdef __APPLE__
 #include "dummydatacontroller.h"
@@ -27,220 +31,930 @@
 #include "udpdatacontroller.h"
 #include "serialdatacontroller.h"
 #endif
+#if !defined(__APPLE__) && !defined(__WINDOWS__)
+#include "socketdatacontroller.h"
+#endif
 #include "dvcontroller.h"
+#include "logger.h"
+#include "decodecache.h"
+#include "silencedetector.h"
+
+namespace SerialDV
+{
+
+// Packets are built so that the length field of the header matches exactly what is sent
+static_assert(DV3000_AUDIO_HEADER[1]*256 + DV3000_AUDIO_HEADER[2] == 2 + MBE_AUDIO_BLOCK_BYTES, "audio packet length");
+static_assert(DV3000_AUDIO_HEADER[5] == MBE_AUDIO_BLOCK_SIZE, "audio packet samples");
+static_assert(DV3000_COMPANDED_AUDIO_HEADER[1]*256 + DV3000_COMPANDED_AUDIO_HEADER[2] == 2 + MBE_AUDIO_BLOCK_SIZE, "companded audio packet length");
+static_assert(DV3000_COMPANDED_AUDIO_HEADER[5] == MBE_AUDIO_BLOCK_SIZE, "companded audio packet samples");
+static_assert(DV3000_AUDIO_HEADER_LEN + MBE_AUDIO_BLOCK_BYTES <= DataController::BUFFER_LENGTH, "audio packet fits in buffer");
+
+/** Checks that descriptors are in DVRate order and that their AMBE header matches the frame size */
+static constexpr bool rateDescriptorsConsistent(unsigned int i)
+{
+    return (i == DV_NB_RATES) || (
+        (DV_RATE_DESCRIPTORS[i].rate == (DVRate) i)
+        && ((DV_RATE_DESCRIPTORS[i].nbBits + 7U) / 8U == DV_RATE_DESCRIPTORS[i].nbBytes)
+        && (DV_RATE_DESCRIPTORS[i].nbBytes <= MBE_FRAME_MAX_LENGTH_BYTES_INTERNAL)
+        && (DV_RATE_DESCRIPTORS[i].ambeHeader[1]*256U + DV_RATE_DESCRIPTORS[i].ambeHeader[2] == DV_RATE_DESCRIPTORS[i].nbBytes + 2U)
+        && (DV_RATE_DESCRIPTORS[i].ambeHeader[5] == DV_RATE_DESCRIPTORS[i].nbBits)
+        && rateDescriptorsConsistent(i + 1));
+}
+
+static_assert(rateDescriptorsConsistent(0), "rate descriptors are consistent");
+
+namespace
+{
+    std::mutex identityCacheMutex;
+    std::map<std::string, std::string> identityCache; //!< device name to product identification
+}
+
+/** Total length of a packet as declared in its header */
+static inline unsigned int packetLength(const unsigned char *packet)
+{
+    return DV3000_HEADER_LEN + packet[1]*256 + packet[2];
+}
+
+const unsigned int DVController::MAX_IN_FLIGHT;
+
+DVController::DVController() :
+        m_serial(nullptr),
+        m_decodeCache(nullptr),
+        m_silenceDetector(nullptr),
+        m_open(false),
+        m_halfSpeed(false),
+        m_responsePolls(2000),
+        m_currentRate(DVRateNone),
+        m_currentGainIn(0),
+        m_currentGainOut(0),
+        m_gainKnown(true),
+        m_currentDescriptor(&DV_RATE_DESCRIPTORS[DVRate3600x2450]),
+        m_companding(DVCompandingNone),
+        m_realTimeThread(nullptr),
+        m_latencyTimerSet(false),
+        m_autoRecovery(false),
+        m_nbRecoveries(0),
+        m_nbFailedRecoveries(0),
+        m_trace(nullptr),
+        m_transportType(TransportGeneric),
+        m_datagram(false),
+        m_inFlightHead(0),
+        m_inFlightRead(0),
+        m_inFlightTail(0),
+        m_rttUs(0.0),
+        m_baseRttUs(0.0),
+        m_serviceUs(0.0),
+        m_lastResponseNs(0),
+        m_lastAloneNs(0),
+        m_latencyCeilingUs(100000),
+        m_window(2),
+        m_batch(1)
+{
+    for (unsigned int i = 0; i < DV_NB_RATES; i++) {
+        m_silenceFrameValid[i] = false;
+    }
+}
+
+DVController::~DVController()
+{
+    delete m_realTimeThread;
+
+    if (m_serial) {
+        delete m_serial;
+    }
+
+    delete m_decodeCache;
+    delete m_silenceDetector;
+    delete m_trace;
+}
+
+bool DVController::open(const std::string& device, bool halfSpeed)
+{
+    return openTransport(createDataController(device), device, halfSpeed, true);
+}
+
+bool DVController::open(DataController *dataController, const std::string& device, bool halfSpeed)
+{
+    return openTransport(dataController, device, halfSpeed, false);
+}
+
+bool DVController::openTransport(DataController *dataController, const std::string& device, bool halfSpeed, bool useIdentityCache)
+{
+    m_open = false;
+    delete m_serial;
+    m_serial = dataController;
+    m_serial->setTrace(m_trace);
+    m_transportType = getTransportType(m_serial);
+    m_datagram = m_serial->isDatagram();
+
+    bool res = m_serial->open(device, halfSpeed ? SERIAL_230400 : SERIAL_460800);
+
+    if (!res) {
+        return false;
+    }
+
+    m_device = device;
+    m_halfSpeed = halfSpeed;
+    m_latencyTimerSet = false;
+    m_productId.clear();
+
+    if (useIdentityCache)
+    {
+        std::lock_guard<std::mutex> lock(identityCacheMutex);
+        std::map<std::string, std::string>::const_iterator it = identityCache.find(device);
+
+        if (it != identityCache.end()) {
+            m_productId = it->second;
+        }
+    }
+
+    if (!m_productId.empty())
+    {
+        SERIALDV_LOG(LogInfo, "DVController::open: DV3000 chip known as: %s", m_productId.c_str());
+        m_open = true;
+    }
+    else if (identify())
+    {
+        m_open = true;
+    }
+    else
+    {
+        m_serial->closeIt();
+        return false;
+    }
+
+    if ((m_companding != DVCompandingNone) && !sendCompanding())
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+DVController::TransportType DVController::getTransportType(DataController *dataController)
+{
+#ifdef __APPLE__
+    if (typeid(*dataController) == typeid(DummyDataController)) {
+        return TransportDummy;
+    }
+#else
+    if (typeid(*dataController) == typeid(SerialDataController)) {
+        return TransportSerial;
+    } else if (typeid(*dataController) == typeid(UDPDataController)) {
+        return TransportUDP;
+    }
+#endif
+#if !defined(__APPLE__) && !defined(__WINDOWS__)
+    if (typeid(*dataController) == typeid(SocketDataController)) {
+        return TransportSocket;
+    }
+#endif
+    return TransportGeneric;
+}
+
+DataController *DVController::createDataController(const std::string& device)
+{
+#ifdef __APPLE__
+    (void) device;
+    return new DummyDataController();
+#else
+#ifndef __WINDOWS__
+    if (SocketDataController::isSocketUri(device)) {
+        return new SocketDataController();
+    }
+#endif
+    if (device.find(':') != std::string::npos) {
+        return new UDPDataController();
+    } else {
+        return new SerialDataController();
+    }
+#endif
+}
+
+bool DVController::identify()
+{
+    uint64_t sentNs = TraceRing::now();
+    writePacket(DV3000_REQ_PRODID, DV3000_REQ_PRODID_LEN);
+
+    PacketView packet;
+    RESP_TYPE type = getResponse(packet);
+
+    if (type == RESP_ERROR)
+    {
+        SERIALDV_LOG(LogError, "DVController::identify: serial device error");
+        return false;
+    }
+    else if (type == RESP_NAME)
+    {
+        const char *name = (const char *) &packet.data[5];
+        m_productId = std::string(name, ::strnlen(name, packet.length - 5));
+        SERIALDV_LOG(LogInfo, "DVController::identify: DV3000 chip identified as: %s", m_productId.c_str());
+        updateTiming(sentNs, true, false); // first estimate of the round trip
+
+        std::lock_guard<std::mutex> lock(identityCacheMutex);
+        identityCache[m_device] = m_productId;
+        return true;
+    }
+    else
+    {
+        SERIALDV_LOG(LogError, "DVController::identify: response mismatch");
+        return false;
+    }
+}
+
+bool DVController::recover()
+{
+    m_nbRecoveries++;
+
+    // 1. skip whatever is left of the packet stream
+    SERIALDV_LOG(LogInfo, "DVController::recover: resynchronize");
+    traceEvent(TraceResync, 1);
+    drain();
+
+    if (identify() && reconfigure()) {
+        return true;
+    }
+
+    // 2. reset the chip
+    SERIALDV_LOG(LogInfo, "DVController::recover: soft reset");
+    traceEvent(TraceResync, 2);
+
+    if (softReset() && identify() && reconfigure()) {
+        return true;
+    }
+
+    // 3. the device may have been unplugged and plugged again
+    SERIALDV_LOG(LogInfo, "DVController::recover: reopen %s", m_device.c_str());
+    traceEvent(TraceResync, 3);
+
+    if (reopen() && identify() && reconfigure()) {
+        return true;
+    }
+
+    SERIALDV_LOG(LogError, "DVController::recover: failed");
+    clearIdentityCache(m_device);
+    m_nbFailedRecoveries++;
+    return false;
+}
+
+void DVController::drain()
+{
+    unsigned char buffer[DataController::BUFFER_LENGTH];
+
+    for (int i = 0; i < 10; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20)); // let bytes in transit arrive
+
+        if (!m_serial->initResponse()) {
+            break;
+        }
+
+        int nbRead = 0;
+        int len;
+
+        while ((len = m_serial->read(buffer, DataController::BUFFER_LENGTH)) > 0) {
+            nbRead += len;
+        }
+
+        if ((len < 0) || (nbRead == 0)) {
+            break;
+        }
+    }
+}
+
+bool DVController::softReset()
+{
+    writePacket(DV3000_REQ_RESET, DV3000_REQ_RESET_LEN);
+
+    PacketView packet;
+
+    if (getResponse(packet) != RESP_READY)
+    {
+        SERIALDV_LOG(LogWarning, "DVController::softReset: no ready packet");
+        return false;
+    }
+
+    drain();
+    return true;
+}
+
+bool DVController::reopen()
+{
+    m_serial->closeIt();
+
+    if (!m_serial->open(m_device, m_halfSpeed ? SERIAL_230400 : SERIAL_460800)) {
+        return false;
+    }
+
+    drain();
+    return true;
+}
+
+bool DVController::reconfigure()
+{
+    if ((m_companding != DVCompandingNone) && !sendCompanding()) {
+        return false;
+    }
+
+    if ((m_currentRate != DVRateNone) && !setRate(*m_currentDescriptor)) {
+        return false;
+    }
+
+    if ((m_currentGainIn != 0) || (m_currentGainOut != 0)) {
+        return setGain(m_currentGainIn, m_currentGainOut);
+    }
+
+    return true;
+}
+
+void DVController::setResponseTimeout(unsigned int timeoutMs)
+{
+    m_responsePolls = timeoutMs * 10;
+}
+
+void DVController::clearIdentityCache(const std::string& device)
+{
+    std::lock_guard<std::mutex> lock(identityCacheMutex);
+
+    if (device.empty()) {
+        identityCache.clear();
+    } else {
+        identityCache.erase(device);
+    }
+}
+
+void DVController::close()
+{
+    stopRealTime();
+    m_inFlightHead = m_inFlightRead = m_inFlightTail = 0;
+
+    if (m_serial) {
+        m_serial->closeIt();
+    }
+
+    m_open = false;
+}
+
+bool DVController::encode(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain)
+{
+    if ((unsigned int) rate >= DV_NB_RATES) {
+        return false;
+    }
+
+    return encodeRate(audioFrame, mbeFrame, DV_RATE_DESCRIPTORS[rate], gain);
+}
+
+bool DVController::decode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain)
+{
+    if ((unsigned int) rate >= DV_NB_RATES) {
+        return false;
+    }
+
+    return decodeRate(audioFrame, mbeFrame, DV_RATE_DESCRIPTORS[rate], gain);
+}
+
+bool DVController::encodeRate(const short *audioFrame, unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain)
+{
+    if (m_realTimeThread)
+    {
+        FrameJob job = {this, audioFrame, mbeFrame, nullptr, nullptr, &rate, gain, false};
+        m_realTimeThread->run(&DVController::runEncodeJob, &job);
+        return job.result;
+    }
+
+    return processEncode(audioFrame, mbeFrame, rate, gain);
+}
+
+bool DVController::decodeRate(short *audioFrame, const unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain)
+{
+    if (m_realTimeThread)
+    {
+        FrameJob job = {this, nullptr, nullptr, audioFrame, mbeFrame, &rate, gain, false};
+        m_realTimeThread->run(&DVController::runDecodeJob, &job);
+        return job.result;
+    }
+
+    return processDecode(audioFrame, mbeFrame, rate, gain);
+}
+
+void DVController::runEncodeJob(void *arg)
+{
+    FrameJob *job = (FrameJob *) arg;
+    job->result = job->controller->processEncode(job->audioIn, job->mbeOut, *job->rate, job->gain);
+}
+
+void DVController::runDecodeJob(void *arg)
+{
+    FrameJob *job = (FrameJob *) arg;
+    job->result = job->controller->processDecode(job->audioOut, job->mbeIn, *job->rate, job->gain);
+}
+
+RealTimeStatus DVController::startRealTime(const RealTimeConfig& config)
+{
+    stopRealTime();
+
+    if (!m_open) {
+        return RealTimeStatus();
+    }
+
+    // once per device lifetime as it needs write access to sysfs
+    if (config.setLatencyTimer && !m_latencyTimerSet) {
+        m_latencyTimerSet = RealTimeThread::setLatencyTimer(m_device, 1);
+    }
+
+    m_realTimeThread = new RealTimeThread();
+    RealTimeStatus status = m_realTimeThread->start(config);
+    status.latencyTimerSet = m_latencyTimerSet;
+
+    SERIALDV_LOG(LogInfo, "DVController::startRealTime: affinity: %s priority: %s memory lock: %s latency timer: %s",
+        config.cpu < 0 ? "n/a" : status.affinitySet ? "OK" : "failed",
+        config.priority <= 0 ? "n/a" : status.prioritySet ? "OK" : "failed",
+        !config.lockMemory ? "n/a" : status.memoryLocked ? "OK" : "failed",
+        !config.setLatencyTimer ? "n/a" : status.latencyTimerSet ? "OK" : "failed");
+
+    return status;
+}
+
+void DVController::stopRealTime()
+{
+    delete m_realTimeThread;
+    m_realTimeThread = nullptr;
+}
+
+RealTimeStatus DVController::getRealTimeStatus() const
+{
+    if (!m_realTimeThread) {
+        return RealTimeStatus();
+    }
+
+    RealTimeStatus status = m_realTimeThread->getStatus();
+    status.latencyTimerSet = m_latencyTimerSet;
+    return status;
+}
+
+void DVController::setTrace(unsigned int capacity)
+{
+    if (m_serial) {
+        m_serial->setTrace(nullptr);
+    }
+
+    delete m_trace;
+    m_trace = capacity > 0 ? new TraceRing(capacity) : nullptr;
+
+    if (m_serial) {
+        m_serial->setTrace(m_trace);
+    }
+}
+
+bool DVController::processEncode(const short *audioFrame, unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain)
+{
+	if (!m_open) {
+		return false;
+	}
+
+    flushInFlight();
+
+    if (m_silenceDetector && m_silenceDetector->isSilence(audioFrame)) {
+        return getSilenceFrame(mbeFrame, rate, gain);
+    }
+
+    return encodeFrame(audioFrame, mbeFrame, rate, gain);
+}
+
+bool DVController::encodeFrame(const short *audioFrame, unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain)
+{
+    if (encodeTransaction(audioFrame, mbeFrame, rate, gain)) {
+        return true;
+    }
+
+    return m_autoRecovery && recover() && encodeTransaction(audioFrame, mbeFrame, rate, gain);
+}
+
+bool DVController::encodeTransaction(const short *audioFrame, unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain)
+{
+    InFlightFrame frame = {true, audioFrame, mbeFrame, nullptr, nullptr, &rate, gain, nullptr, false, false, false, 0, nullptr, 0};
+    sendFrame(frame);
+    return receiveResponses(frame);
+}
+
+bool DVController::processDecode(short *audioFrame, const unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain)
+{
+	if (!m_open) {
+		return false;
+	}
+
+    flushInFlight();
+
+    if (m_decodeCache && m_decodeCache->lookup(rate.rate, gain, mbeFrame, audioFrame)) {
+        return true;
+    }
+
+    if (!decodeFrame(audioFrame, mbeFrame, rate, gain)) {
+        return false;
+    }
+
+    if (m_decodeCache) {
+        m_decodeCache->store(rate.rate, gain, mbeFrame, audioFrame);
+    }
+
+    return true;
+}
+
+bool DVController::decodeFrame(short *audioFrame, const unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain)
+{
+    if (decodeTransaction(audioFrame, mbeFrame, rate, gain)) {
+        return true;
+    }
+
+    return m_autoRecovery && recover() && decodeTransaction(audioFrame, mbeFrame, rate, gain);
+}
+
+bool DVController::decodeTransaction(short *audioFrame, const unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain)
+{
+    InFlightFrame frame = {false, nullptr, nullptr, audioFrame, mbeFrame, &rate, gain, nullptr, false, false, false, 0, nullptr, 0};
+    sendFrame(frame);
+    return receiveResponses(frame);
+}
+
+bool DVController::submitEncode(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain, void *userData)
+{
+    assert(audioFrame != 0);
+    assert(mbeFrame != 0);
+
+    if ((unsigned int) rate >= DV_NB_RATES) {
+        return false;
+    }
+
+    InFlightFrame frame = {true, audioFrame, mbeFrame, nullptr, nullptr, &DV_RATE_DESCRIPTORS[rate], gain, userData, false, false, false, 0, nullptr, 0};
+    return submitFrame(frame);
+}
+
+bool DVController::submitDecode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain, void *userData)
+{
+    assert(audioFrame != 0);
+    assert(mbeFrame != 0);
+
+    if ((unsigned int) rate >= DV_NB_RATES) {
+        return false;
+    }
+
+    InFlightFrame frame = {false, nullptr, nullptr, audioFrame, mbeFrame, &DV_RATE_DESCRIPTORS[rate], gain, userData, false, false, false, 0, nullptr, 0};
+    return submitFrame(frame);
+}
+
+bool DVController::submitFrame(const InFlightFrame& frame)
+{
+    if (m_realTimeThread)
+    {
+        PipelineJob job = {this, &frame, nullptr, 0};
+        m_realTimeThread->run(&DVController::runSubmitJob, &job);
+        return job.result != 0;
+    }
+
+    return processSubmit(frame);
+}
+
+bool DVController::processSubmit(const InFlightFrame& frame)
+{
+    if (!m_open || (getNbInFlight() == MAX_IN_FLIGHT)) {
+        return false;
+    }
+
+    InFlightFrame& slot = inFlightFrame(m_inFlightTail);
+    slot = frame;
+
+    // frames answered on the host complete at once but are still collected in order
+    if (frame.encode && m_silenceDetector && m_silenceDetector->isSilence(frame.audioIn))
+    {
+        slot.result = getSilenceFrame(frame.mbeOut, *frame.rate, frame.gain);
+        slot.completed = true;
+    }
+    else if (!frame.encode && m_decodeCache && m_decodeCache->lookup(frame.rate->rate, frame.gain, frame.mbeIn, frame.audioOut))
+    {
+        slot.result = true;
+        slot.completed = true;
+    }
+    else
+    {
+        sendFrame(slot);
+    }
+
+    m_inFlightTail++;
+    return true;
+}
+
+void DVController::sendFrame(InFlightFrame& frame)
+{
+    unsigned char buffer[DV3000_REQ_RATEP_LEN + DV3000_REQ_GAIN_LEN + 2 + DV3000_AUDIO_HEADER_LEN + MBE_AUDIO_BLOCK_BYTES];
+    unsigned int length = 0;
+    int gainIn = frame.encode ? frame.gain : m_currentGainIn;
+    int gainOut = frame.encode ? m_currentGainOut : frame.gain;
+    frame.controls = 0;
+
+    // control packets go in the same write as the data packet and their responses are read before its response
+    if (frame.rate->rate != m_currentRate)
+    {
+        if (frame.rate->ratep)
+        {
+            ::memcpy(buffer, frame.rate->ratep, DV3000_REQ_RATEP_LEN);
+            length += DV3000_REQ_RATEP_LEN;
+            frame.controls |= CONTROL_RATEP;
+            m_currentDescriptor = frame.rate;
+        }
+
+        m_currentRate = frame.rate->rate;
+    }
+
+    if ((gainIn != m_currentGainIn) || (gainOut != m_currentGainOut) || !m_gainKnown)
+    {
+        length += gainPacket(gainIn, gainOut, buffer + length);
+        frame.controls |= CONTROL_GAIN;
+        m_currentGainIn = gainIn;
+        m_currentGainOut = gainOut;
+        m_gainKnown = true;
+    }
+
+    frame.descriptor = m_currentDescriptor;
+
+    if (frame.encode) {
+        length += encodeIn(frame.audioIn, buffer + length);
+    } else {
+        length += decodeIn(frame.mbeIn, *frame.descriptor, buffer + length);
+    }
+
+    frame.submitNs = TraceRing::now();
+    frame.alone = m_inFlightRead == m_inFlightTail;
+
+    if (m_datagram)
+    {
+        // one packet per datagram
+        for (unsigned int offset = 0; offset < length; offset += packetLength(buffer + offset)) {
+            writePacket(buffer + offset, packetLength(buffer + offset));
+        }
+    }
+    else
+    {
+        writePacket(buffer, length);
+    }
+}
+
+bool DVController::receiveResponses(InFlightFrame& frame)
+{
+    bool configured = true;
+    PacketView packet;
+
+    if (frame.controls & CONTROL_RATEP)
+    {
+        if ((getResponse(packet) == RESP_RATEP) && (packet.length > 5) && (packet.data[5] == 0x00U))
+        {
+            SERIALDV_LOG(LogDebug, "DVController::receiveResponses: rate %d: OK", (int) frame.descriptor->rate);
+            traceEvent(TraceRateChange, frame.descriptor->rate);
+        }
+        else
+        {
+            SERIALDV_LOG(LogError, "DVController::receiveResponses: rate %d not set", (int) frame.descriptor->rate);
+            m_currentRate = DVRateNone; // unknown device rate: sent again with the next frame
+            configured = false;
+        }
+    }
+
+    if (frame.controls & CONTROL_GAIN)
+    {
+        if ((getResponse(packet) == RESP_GAIN) && (packet.length > 5) && (packet.data[5] == 0x00U))
+        {
+            SERIALDV_LOG(LogDebug, "DVController::receiveResponses: gain: OK");
+        }
+        else
+        {
+            SERIALDV_LOG(LogError, "DVController::receiveResponses: gain not set");
+            m_gainKnown = false;
+            configured = false;
+        }
+    }
+
+    // the data response is read in any case to stay in step with the device
+    bool ok = frame.encode ?
+        encodeOut(frame.mbeOut, *frame.descriptor) :
+        decodeOut(frame.audioOut, MBE_AUDIO_BLOCK_SIZE);
+
+    if (!ok || !configured) {
+        return false;
+    }
+
+    // the device was busy with this frame since the previous response if it was sent before it
+    updateTiming(frame.submitNs, frame.alone, frame.submitNs < m_lastResponseNs);
+    return true;
+}
+
+bool DVController::receiveFrame(InFlightFrame& frame)
+{
+    bool ok = receiveResponses(frame);
+
+    if (!ok && m_autoRecovery)
+    {
+        if (recover())
+        {
+            // the responses of this frame and the ones behind it are lost: send them again
+            for (unsigned int i = m_inFlightRead; i != m_inFlightTail; i++)
+            {
+                if (!inFlightFrame(i).completed) {
+                    sendFrame(inFlightFrame(i));
+                }
+            }
+
+            ok = receiveResponses(frame);
+        }
+        else
+        {
+            for (unsigned int i = m_inFlightRead + 1; i != m_inFlightTail; i++)
+            {
+                inFlightFrame(i).result = false;
+                inFlightFrame(i).completed = true;
+            }
+        }
+    }
+
+    if (ok && !frame.encode && m_decodeCache) {
+        m_decodeCache->store(frame.rate->rate, frame.gain, frame.mbeIn, frame.audioOut);
+    }
+
+    return ok;
+}
+
+void DVController::receiveInFlight(unsigned int end)
+{
+    for (; (int) (end - m_inFlightRead) > 0; m_inFlightRead++)
+    {
+        InFlightFrame& frame = inFlightFrame(m_inFlightRead);
+
+        if (!frame.completed)
+        {
+            frame.result = receiveFrame(frame);
+            frame.completed = true;
+        }
+    }
+}
+
+void DVController::updateTiming(uint64_t sentNs, bool alone, bool queued)
+{
+    uint64_t nowNs = TraceRing::now();
+    double rttUs = (nowNs - sentNs) / 1000.0;
+    m_rttUs = m_rttUs == 0.0 ? rttUs : m_rttUs + (rttUs - m_rttUs) / 8.0;
+
+    if (alone)
+    {
+        // frames queued behind others would also measure the queueing
+        m_baseRttUs = (m_baseRttUs == 0.0) || (rttUs < m_baseRttUs) ? rttUs : m_baseRttUs + (rttUs - m_baseRttUs) / 4.0;
+        m_lastAloneNs = nowNs;
+    }
+
+    if (queued) {
+        m_serviceUs = m_serviceUs == 0.0 ? (nowNs - m_lastResponseNs) / 1000.0 : m_serviceUs + ((nowNs - m_lastResponseNs) / 1000.0 - m_serviceUs) / 8.0;
+    }
+
+    m_lastResponseNs = nowNs;
+
+    // device is never slower than one frame per round trip
+    double serviceUs = (m_serviceUs == 0.0) || (m_serviceUs > m_baseRttUs) ? m_baseRttUs : m_serviceUs;
+    serviceUs = serviceUs < 1.0 ? 1.0 : serviceUs;
+    unsigned int busyFrames = (unsigned int) std::ceil(m_baseRttUs / serviceUs);
+    busyFrames = busyFrames < 1 ? 1 : busyFrames;
+    unsigned int window = 2*busyFrames;
+    unsigned int ceilingFrames = (unsigned int) (m_latencyCeilingUs / serviceUs);
+    window = window > ceilingFrames ? ceilingFrames : window;
+    window = window > MAX_IN_FLIGHT ? MAX_IN_FLIGHT : window < 1 ? 1 : window;
+    m_window = window;
+    m_batch = window > busyFrames ? window - busyFrames : 1;
+
+    if (nowNs - m_lastAloneNs > 2000000000ULL)
+    {
+        // let the frames in flight drain to sample the base round trip again
+        m_window = 1;
+        m_batch = 1;
+    }
+}
 
-namespace SerialDV
+void DVController::setLatencyCeiling(unsigned int latencyUs)
 {
+    m_latencyCeilingUs = latencyUs;
+}
 
-DVController::DVController() :
-        m_serial(nullptr),
-        m_open(false),
-        m_currentRate(DVRateNone),
-        m_currentGainIn(0),
-        m_currentGainOut(0),
-        m_currentNbMbeBits(72),
-        m_currentNbMbeBytes(9)
+DVPipelineStats DVController::getPipelineStats() const
 {
-    m_littleEndian = isLittleEndian();
+    DVPipelineStats stats;
+    stats.rttUs = (unsigned int) m_rttUs;
+    stats.baseRttUs = (unsigned int) m_baseRttUs;
+    stats.serviceUs = (unsigned int) m_serviceUs;
+    stats.window = m_window;
+    stats.batch = m_batch;
+    stats.latencyCeilingUs = m_latencyCeilingUs;
+    return stats;
 }
 
-DVController::~DVController()
+int DVController::collect(void **userData)
 {
-    if (m_serial) {
-        delete m_serial;
+    if (m_realTimeThread)
+    {
+        PipelineJob job = {this, nullptr, userData, 0};
+        m_realTimeThread->run(&DVController::runCollectJob, &job);
+        return job.result;
     }
+
+    return processCollect(userData);
 }
 
-bool DVController::open(const std::string& device, bool halfSpeed)
+void DVController::runSubmitJob(void *arg)
 {
-    m_open = false;
+    PipelineJob *job = (PipelineJob *) arg;
+    job->result = job->controller->processSubmit(*job->frame) ? 1 : 0;
+}
 
-#ifdef __APPLE__
-    m_serial = new DummyDataController();
-#else
-    if (device.find(':') != std::string::npos) {
-        m_serial = new UDPDataController();
-    } else {
-        m_serial = new SerialDataController();
+void DVController::runCollectJob(void *arg)
+{
+    PipelineJob *job = (PipelineJob *) arg;
+    job->result = job->controller->processCollect(job->userData);
+}
+
+int DVController::processCollect(void **userData)
+{
+    if (m_inFlightHead == m_inFlightTail) {
+        return -1;
     }
-#endif
 
-    bool res = m_serial->open(device, halfSpeed ? SERIAL_230400 : SERIAL_460800);
+    receiveInFlight(m_inFlightHead + 1);
+    InFlightFrame& frame = inFlightFrame(m_inFlightHead++);
 
-    if (!res) {
-        return false;
+    if (userData) {
+        *userData = frame.userData;
     }
 
-    m_serial->write(DV3000_REQ_PRODID, DV3000_REQ_PRODID_LEN);
-
-    unsigned char buffer[DataController::BUFFER_LENGTH];
-    RESP_TYPE type = getResponse(buffer, DataController::BUFFER_LENGTH);
+    return frame.result ? 1 : 0;
+}
 
-    if (type == RESP_ERROR)
-    {
-        fprintf(stderr, "DVController::open: serial device error\n");
-        m_serial->closeIt();
-        return false;
-    }
-    else if (type == RESP_NAME)
-    {
-        std::string name((char *) &buffer[5]);
-        fprintf(stderr, "DVController::open: DV3000 chip identified as: %s\n", name.c_str());
-        m_open = true;
-        return true;
-    }
-    else
-    {
-        fprintf(stderr, "DVController::open: response mismatch\n");
-        m_serial->closeIt();
-        return false;
-    }
+void DVController::setDecodeCache(unsigned int maxEntries)
+{
+    delete m_decodeCache;
+    m_decodeCache = maxEntries > 0 ? new DecodeCache(maxEntries) : nullptr;
 }
 
-void DVController::close()
+void DVController::setSilenceDetection(bool enable, float thresholdDb, unsigned int hangoverFrames)
 {
-    m_serial->closeIt();
-    m_open = false;
+    delete m_silenceDetector;
+    m_silenceDetector = enable ? new SilenceDetector(thresholdDb, hangoverFrames) : nullptr;
 }
 
-bool DVController::encode(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain)
+void DVController::setSilenceFrame(DVRate rate, const unsigned char *mbeFrame)
 {
-	if (!m_open) {
-		return false;
-	}
+    unsigned short nbBytes = getNbMbeBytes(rate);
 
-	if (rate != m_currentRate)
-	{
-	    setRate(rate);
-	    m_currentRate = rate;
-	}
+    if (nbBytes == 0) {
+        return;
+    }
 
-	if (gain != m_currentGainIn)
-	{
-	    setGain(gain, m_currentGainOut);
-	    m_currentGainIn = gain;
-	}
-	encodeIn(audioFrame, MBE_AUDIO_BLOCK_SIZE_INTERNAL);
-	return encodeOut(mbeFrame, m_currentNbMbeBytes);
+    ::memcpy(m_silenceFrames[rate], mbeFrame, nbBytes);
+    m_silenceFrameValid[rate] = true;
 }
 
-
-bool DVController::decode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain)
+bool DVController::getSilenceFrame(unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain)
 {
-	if (!m_open) {
-		return false;
-	}
-
-    if (rate != m_currentRate)
-    {
-        setRate(rate);
-        m_currentRate = rate;
+    if (rate.nbBytes == 0) {
+        return false;
     }
 
-    if (gain != m_currentGainOut)
+    if (!m_silenceFrameValid[rate.rate])
     {
-        setGain(m_currentGainIn, gain);
-        m_currentGainOut = gain;
+        flushInFlight();
+        // encode digital silence twice so that the encoder has settled
+        short zeroFrame[MBE_AUDIO_BLOCK_SIZE];
+        ::memset(zeroFrame, 0, sizeof(zeroFrame));
+
+        for (int i = 0; i < 2; i++)
+        {
+            if (!encodeFrame(zeroFrame, m_silenceFrames[rate.rate], rate, gain)) {
+                return false;
+            }
+        }
+
+        m_silenceFrameValid[rate.rate] = true;
     }
 
-	decodeIn(mbeFrame, m_currentNbMbeBits, m_currentNbMbeBytes);
-	return decodeOut(audioFrame, MBE_AUDIO_BLOCK_SIZE_INTERNAL);
+    ::memcpy(mbeFrame, m_silenceFrames[rate.rate], rate.nbBytes);
+    return true;
 }
 
 unsigned short DVController::getNbMbeBytes(DVRate mbeRate)
 {
-    switch (mbeRate)
-    {
-    case DVRateNone:
-        return 0;
-    case DVRate3600x2400:
-        return 9;
-        break;
-    case DVRate3600x2450:
-        return 9;
-        break;
-    case DVRate7200x4400:
-        return 18;
-        break;
-    case DVRate2450:
-        return 7;
-        break;
-    case DVRate4400:
-        return 11;
-        break;
-    case DVRate2200:
-        return 6;
-        break;
-    case DVRate3000:
-        return 8;
-        break;
-    case DVRate6400:
-        return 16;
-        break;
-    case DVRate7200:
-        return 18;
-        break;
-    case DVRate8000:
-        return 20;
-        break;
-    case DVRate9600:
-        return 24;
-        break;
-    default:
-        return 0;
-    }
+    return (unsigned int) mbeRate < DV_NB_RATES ? DV_RATE_DESCRIPTORS[mbeRate].nbBytes : 0;
 }
 
 unsigned char DVController::getNbMbeBits(DVRate mbeRate)
 {
-    switch (mbeRate)
-    {
-    case DVRateNone:
-        return 0;
-    case DVRate3600x2400:
-        return 72;
-        break;
-    case DVRate3600x2450:
-        return 72;
-        break;
-    case DVRate7200x4400:
-        return 144;
-        break;
-    case DVRate2450:
-        return 49;
-        break;
-    case DVRate4400:
-        return 88;
-        break;
-    case DVRate2200:
-        return 44;
-        break;
-    case DVRate3000:
-        return 60;
-        break;
-    case DVRate6400:
-        return 128;
-        break;
-    case DVRate7200:
-        return 144;
-        break;
-    case DVRate8000:
-        return 160;
-        break;
-    case DVRate9600:
-        return 192;
-        break;
-    default:
-        return 0;
-    }
+    return (unsigned int) mbeRate < DV_NB_RATES ? DV_RATE_DESCRIPTORS[mbeRate].nbBits : 0;
 }
 
-bool DVController::setGain(signed char dBGainIn, signed char dBGainOut)
+unsigned int DVController::gainPacket(signed char dBGainIn, signed char dBGainOut, unsigned char *packet)
 {
-    if (!m_open) {
-        return false;
-    }
-
     if (dBGainIn < -90) {
         dBGainIn = -90;
     } else if (dBGainIn > 90) {
@@ -253,118 +967,193 @@ bool DVController::setGain(signed char dBGainIn, signed char dBGainOut)
         dBGainOut = 90;
     }
 
-    unsigned char buffer[DV3000_REQ_GAIN_LEN + 2];
-    ::memcpy(buffer, DV3000_REQ_GAIN, DV3000_REQ_GAIN_LEN);
+    ::memcpy(packet, DV3000_REQ_GAIN, DV3000_REQ_GAIN_LEN);
+    packet[DV3000_REQ_GAIN_LEN]   = dBGainIn;
+    packet[DV3000_REQ_GAIN_LEN+1] = dBGainOut;
+    return DV3000_REQ_GAIN_LEN + 2;
+}
 
-    buffer[DV3000_REQ_GAIN_LEN]   = dBGainIn;
-    buffer[DV3000_REQ_GAIN_LEN+1] = dBGainOut;
+bool DVController::setGain(signed char dBGainIn, signed char dBGainOut)
+{
+    if (!m_open) {
+        return false;
+    }
 
-    m_serial->write(buffer, DV3000_REQ_GAIN_LEN + 2);
-    RESP_TYPE type = getResponse(buffer, DataController::BUFFER_LENGTH);
+    unsigned char buffer[DV3000_REQ_GAIN_LEN + 2];
+    writePacket(buffer, gainPacket(dBGainIn, dBGainOut, buffer));
+    PacketView packet;
+    RESP_TYPE type = getResponse(packet);
 
     if (type == RESP_ERROR)
     {
-        fprintf(stderr, "DVController::setGain: serial device error\n");
+        SERIALDV_LOG(LogError, "DVController::setGain: serial device error");
         return false;
     }
     else if (type == RESP_GAIN)
     {
-        fprintf(stderr, "DVController::setGain: in: %d dB out: %d dB: OK\n", (int) dBGainIn, (int) dBGainOut);
+        SERIALDV_LOG(LogDebug, "DVController::setGain: in: %d dB out: %d dB: OK", (int) dBGainIn, (int) dBGainOut);
         return true;
     }
     else
     {
-        fprintf(stderr, "DVController::setGain: response mismatch\n");
+        SERIALDV_LOG(LogError, "DVController::setGain: response mismatch");
         return false;
     }
 }
 
-void DVController::encodeIn(const short* audio, unsigned int length)
-{   
-    (void) length;
+bool DVController::setCompanding(DVCompanding companding)
+{
+    m_companding = companding;
+
+    if (!m_open) {
+        return true;
+    }
+
+    flushInFlight();
+    return sendCompanding();
+}
+
+bool DVController::sendCompanding()
+{
+    unsigned char buffer[DV3000_REQ_COMPAND_LEN + 1];
+    ::memcpy(buffer, DV3000_REQ_COMPAND, DV3000_REQ_COMPAND_LEN);
+
+    if (m_companding == DVCompandingULaw) {
+        buffer[DV3000_REQ_COMPAND_LEN] = 0x01U;
+    } else if (m_companding == DVCompandingALaw) {
+        buffer[DV3000_REQ_COMPAND_LEN] = 0x03U;
+    } else {
+        buffer[DV3000_REQ_COMPAND_LEN] = 0x00U;
+    }
+
+    writePacket(buffer, DV3000_REQ_COMPAND_LEN + 1);
+    PacketView packet;
+    RESP_TYPE type = getResponse(packet);
+
+    if ((type == RESP_COMPAND) && (packet.length > 5) && (packet.data[5] == 0x00U))
+    {
+        SERIALDV_LOG(LogDebug, "DVController::sendCompanding: %d: OK", (int) m_companding);
+        return true;
+    }
+    else
+    {
+        SERIALDV_LOG(LogError, "DVController::sendCompanding: error");
+        m_companding = DVCompandingNone; // state of the device is unknown but at least not consistent
+        return false;
+    }
+}
+
+unsigned int DVController::encodeIn(const short* audio, unsigned char *buffer)
+{
     assert(audio != 0);
-    assert(length == MBE_AUDIO_BLOCK_SIZE_INTERNAL);
 
-    // TODO: optimization with fixed initialization of the audio header
-    unsigned char buffer[DV3000_AUDIO_HEADER_LEN + MBE_AUDIO_BLOCK_BYTES_INTERNAL];
+    if (m_companding != DVCompandingNone)
+    {
+        ::memcpy(buffer, DV3000_COMPANDED_AUDIO_HEADER, DV3000_AUDIO_HEADER_LEN);
+
+        if (m_companding == DVCompandingULaw) {
+            Companding::linearToULaw(audio, buffer + DV3000_AUDIO_HEADER_LEN, MBE_AUDIO_BLOCK_SIZE);
+        } else {
+            Companding::linearToALaw(audio, buffer + DV3000_AUDIO_HEADER_LEN, MBE_AUDIO_BLOCK_SIZE);
+        }
+
+        assert(packetLength(buffer) == DV3000_AUDIO_HEADER_LEN + MBE_AUDIO_BLOCK_SIZE);
+        return DV3000_AUDIO_HEADER_LEN + MBE_AUDIO_BLOCK_SIZE;
+    }
 
     ::memcpy(buffer, DV3000_AUDIO_HEADER, DV3000_AUDIO_HEADER_LEN);
 
     uint8_t* q = (uint8_t*) (buffer + DV3000_AUDIO_HEADER_LEN);
 
-    for (unsigned int i = 0; i < MBE_AUDIO_BLOCK_SIZE_INTERNAL; i++, q += 2U)
+    for (unsigned int i = 0; i < MBE_AUDIO_BLOCK_SIZE; i++, q += 2U)
     {
         q[0U] = (audio[i] & 0xFF00) >> 8;
         q[1U] = (audio[i] & 0x00FF) >> 0;
     }
 
-    m_serial->write(buffer, DV3000_AUDIO_HEADER_LEN + MBE_AUDIO_BLOCK_BYTES_INTERNAL);
+    assert(packetLength(buffer) == DV3000_AUDIO_HEADER_LEN + MBE_AUDIO_BLOCK_BYTES);
+    return DV3000_AUDIO_HEADER_LEN + MBE_AUDIO_BLOCK_BYTES;
 }
 
-bool DVController::encodeOut(unsigned char* ambe, unsigned int length)
+bool DVController::encodeOut(unsigned char* ambe, const DVRateDescriptor& rate)
 {
     assert(ambe != 0);
-    assert(length == m_currentNbMbeBytes);
+    unsigned int length = rate.nbBytes;
 
-    unsigned char buffer[DataController::BUFFER_LENGTH];
-    RESP_TYPE type = getResponse(buffer, DataController::BUFFER_LENGTH);
+    PacketView packet;
+    RESP_TYPE type = getResponse(packet);
 
     if (type != RESP_AMBE)
     {
-        fprintf(stderr, "DVController::encodeOut: error\n");
+        SERIALDV_LOG(LogError, "DVController::encodeOut: error");
+        return false;
+    }
+
+    // CHAND field with the number of bits followed by the bytes
+    if ((packet.length != DV3000_AMBE_HEADER_LEN + length) || (packet.data[5] != rate.nbBits))
+    {
+        SERIALDV_LOG(LogError, "DVController::encodeOut: unexpected %u bits frame in %u bytes packet",
+            packet.length > 5 ? (unsigned int) packet.data[5] : 0U, packet.length);
         return false;
     }
 
-    ::memcpy(ambe, buffer + DV3000_AMBE_HEADER_LEN, length);
+    ::memcpy(ambe, packet.data + DV3000_AMBE_HEADER_LEN, length);
 
     return true;
 }
 
-void DVController::decodeIn(const unsigned char* ambe, unsigned char nbBits, unsigned short nbBytes)
+unsigned int DVController::decodeIn(const unsigned char* ambe, const DVRateDescriptor& rate, unsigned char *buffer)
 {
     assert(ambe != 0);
-    assert(nbBytes == m_currentNbMbeBytes);
-    unsigned short length = nbBytes + 2;
-    unsigned char *lengthPtr = (unsigned char *) &length;
-
-    unsigned char buffer[DV3000_AMBE_HEADER_LEN + MBE_FRAME_MAX_LENGTH_BYTES_INTERNAL];
-    ::memcpy(buffer, DV3000_AMBE_HEADER, DV3000_AMBE_HEADER_LEN);
-    ::memcpy(buffer + DV3000_AMBE_HEADER_LEN, ambe, nbBytes);
-
-    if (m_littleEndian)
-    {
-        ::memcpy(&buffer[1], &lengthPtr[1], 1); // set header length field with little endian byte order
-        ::memcpy(&buffer[2], &lengthPtr[0], 1); // set header length field with little endian byte order
-    }
-    else
-    {
-        ::memcpy(&buffer[1], &lengthPtr[0], 1); // set header length field with big endian byte order
-        ::memcpy(&buffer[2], &lengthPtr[1], 1); // set header length field with big endian byte order
-    }
+    assert(rate.nbBytes <= MBE_FRAME_MAX_LENGTH_BYTES_INTERNAL);
 
-    ::memcpy(&buffer[5], &nbBits, 1); // set CHAND number of bits
+    ::memcpy(buffer, rate.ambeHeader, DV3000_AMBE_HEADER_LEN); // length and CHAND number of bits are preset
+    ::memcpy(buffer + DV3000_AMBE_HEADER_LEN, ambe, rate.nbBytes);
 
-    m_serial->write(buffer, DV3000_AMBE_HEADER_LEN + nbBytes);
+    assert(packetLength(buffer) == DV3000_AMBE_HEADER_LEN + (unsigned int) rate.nbBytes);
+    return DV3000_AMBE_HEADER_LEN + rate.nbBytes;
 }
 
 bool DVController::decodeOut(short* audio, unsigned int length)
 {
     (void) length;
     assert(audio != 0);
-    assert(length == MBE_AUDIO_BLOCK_SIZE_INTERNAL);
+    assert(length == MBE_AUDIO_BLOCK_SIZE);
 
-    unsigned char buffer[DataController::BUFFER_LENGTH];
-    RESP_TYPE type = getResponse(buffer, DataController::BUFFER_LENGTH);
+    PacketView packet;
+    RESP_TYPE type = getResponse(packet);
 
     if (type != RESP_AUDIO)
     {
-        fprintf(stderr, "DVController::decodeOut: error\n");
+        SERIALDV_LOG(LogError, "DVController::decodeOut: error");
         return false;
     }
 
-    uint8_t* q = (uint8_t*) (buffer + DV3000_AUDIO_HEADER_LEN);
+    // SPEECHD field with the number of samples followed by the samples
+    unsigned int sampleBytes = m_companding == DVCompandingNone ? 2 : 1;
+
+    if ((packet.length != DV3000_AUDIO_HEADER_LEN + MBE_AUDIO_BLOCK_SIZE*sampleBytes)
+     || (packet.data[5] != MBE_AUDIO_BLOCK_SIZE))
+    {
+        SERIALDV_LOG(LogError, "DVController::decodeOut: unexpected %u samples in %u bytes packet",
+            packet.length > 5 ? (unsigned int) packet.data[5] : 0U, packet.length);
+        return false;
+    }
+
+    if (m_companding == DVCompandingULaw)
+    {
+        Companding::uLawToLinear(packet.data + DV3000_AUDIO_HEADER_LEN, audio, MBE_AUDIO_BLOCK_SIZE);
+        return true;
+    }
+    else if (m_companding == DVCompandingALaw)
+    {
+        Companding::aLawToLinear(packet.data + DV3000_AUDIO_HEADER_LEN, audio, MBE_AUDIO_BLOCK_SIZE);
+        return true;
+    }
 
-    for (unsigned int i = 0U; i < MBE_AUDIO_BLOCK_SIZE_INTERNAL; i++, q += 2U)
+    const uint8_t* q = packet.data + DV3000_AUDIO_HEADER_LEN;
+
+    for (unsigned int i = 0U; i < MBE_AUDIO_BLOCK_SIZE; i++, q += 2U)
     {
         short word = (q[0] << 8) | (q[1U] << 0);
         audio[i] = word;
@@ -373,209 +1162,82 @@ bool DVController::decodeOut(short* audio, unsigned int length)
     return true;
 }
 
-bool DVController::setRate(DVRate rate)
+bool DVController::setRate(const DVRateDescriptor& rate)
 {
-    fprintf(stderr, "DVController::setRate begin \n");
+    SERIALDV_LOG(LogDebug, "DVController::setRate begin");
     if (!m_open) {
         return false;
     }
 
-    if (rate == DVRateNone) {
+    if (rate.ratep == nullptr) {
         return true;
     }
 
-    const unsigned char *ratepStr;
-
-    switch(rate)
-    {
-    case DVRateNone:
-        return true;
-    case DVRate3600x2400:
-        ratepStr = DV3000_REQ_3600X2400_RATEP;
-        m_currentNbMbeBits = 72;
-        m_currentNbMbeBytes = 9;
-        break;
-    case DVRate3600x2450:
-        ratepStr = DV3000_REQ_3600X2450_RATEP;
-        m_currentNbMbeBits = 72;
-        m_currentNbMbeBytes = 9;
-        break;
-    case DVRate7200x4400:
-        ratepStr = DV3000_REQ_7200X4400_3_RATEP; // AMBE 3000 version
-        m_currentNbMbeBits = 144;
-        m_currentNbMbeBytes = 18;
-        break;
-    case DVRate2450:
-        ratepStr = DV3000_REQ_2450_RATEP;
-        m_currentNbMbeBits = 49;
-        m_currentNbMbeBytes = 7;
-        break;
-    case DVRate4400:
-        ratepStr = DV3000_REQ_4400_RATEP;
-        m_currentNbMbeBits = 88;
-        m_currentNbMbeBytes = 11;
-        break;
-    case DVRate2200:
-        ratepStr = DV3000_REQ_2200_RATEP;
-        m_currentNbMbeBits = 44;
-        m_currentNbMbeBytes = 6;
-        break;
-    case DVRate3000:
-        ratepStr = DV3000_REQ_3000_RATEP;
-        m_currentNbMbeBits = 60;
-        m_currentNbMbeBytes = 8;
-        break;
-    case DVRate6400:
-        ratepStr = DV3000_REQ_6400_RATEP;
-        m_currentNbMbeBits = 128;
-        m_currentNbMbeBytes = 16;
-        break;
-    case DVRate7200:
-        ratepStr = DV3000_REQ_7200_RATEP;
-        m_currentNbMbeBits = 144;
-        m_currentNbMbeBytes = 18;
-        break;
-    case DVRate8000:
-        ratepStr = DV3000_REQ_8000_RATEP;
-        m_currentNbMbeBits = 160;
-        m_currentNbMbeBytes = 20;
-        break;
-    case DVRate9600:
-        ratepStr = DV3000_REQ_9600_RATEP;
-        m_currentNbMbeBits = 192;
-        m_currentNbMbeBytes = 24;
-        break;
-    default:
-        return true;
-    }
+    const unsigned char *ratepStr = rate.ratep;
+    m_currentDescriptor = &DV_RATE_DESCRIPTORS[rate.rate];
 
-    m_serial->write(ratepStr, DV3000_REQ_RATEP_LEN);
+    writePacket(ratepStr, DV3000_REQ_RATEP_LEN);
 
-    unsigned char buffer[DataController::BUFFER_LENGTH];
-    RESP_TYPE type = getResponse(buffer, DataController::BUFFER_LENGTH);
+    PacketView packet;
+    RESP_TYPE type = getResponse(packet);
 
     if (type == RESP_ERROR)
     {
-        fprintf(stderr, "DVController::setRate: serial device error\n");
+        SERIALDV_LOG(LogError, "DVController::setRate: serial device error");
         return false;
     }
     else if (type == RESP_RATEP)
     {
-        fprintf(stderr, "DVController::setRate (%d): OK\n", (int) rate);
+        SERIALDV_LOG(LogDebug, "DVController::setRate (%d): OK", (int) rate.rate);
+        traceEvent(TraceRateChange, rate.rate);
         return true;
     }
     else
     {
-        fprintf(stderr, "DVController::setRate: response mismatch\n");
+        SERIALDV_LOG(LogError, "DVController::setRate: response mismatch");
         return false;
     }
-    fprintf(stderr, "DVController::setRate begin \n");
-
 }
 
-DVController::RESP_TYPE DVController::getResponse(unsigned char* buffer, unsigned int length)
+DVController::RESP_TYPE DVController::getResponse(PacketView& packet)
 {
-    (void) length;
-    assert(buffer != 0);
-    assert(length >= DataController::BUFFER_LENGTH);
-
-    if (!m_serial->initResponse())
-    {
-        fprintf(stderr, "DVController::getResponse: cannot get response\n");
-        return RESP_ERROR;
-    }
-
-    bool found = false;
-    int packetLength, offset;
-    unsigned char packetType;
+    int length;
 
-    for (int i = 0; i < 2000; i++)
+    // resolve the transport once per packet so that the calls to the transport classes are direct
+    switch (m_transportType)
     {
-        int len1 = m_serial->read(buffer, 1U);
-
-        if (len1 < 0)
-        {
-            fprintf(stderr, "DVController::getResponse: Error (start byte)\n");
-            return RESP_ERROR;
-        }
-        else if ((len1 == 1) && (buffer[0U] == DV3000_START_BYTE))
-        {
-            found = true;
-            break;
-        }
-
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
-    }
-
-    if (!found)
-    {
-        fprintf(stderr, "DVController::getResponse: Timeout (start byte)\n");
-        return RESP_ERROR;
-    }
-
-    packetLength = 3;
-    offset = 0;
-    found = false;
-
-    for (int i = 0; i < 2000; i++)
-    {
-        int len1 = m_serial->read(&buffer[1 + offset], packetLength - offset);
-
-        if (len1 < 0)
-        {
-            fprintf(stderr, "DVController::getResponse: Error (packet header at %d)\n", offset);
-            return RESP_ERROR;
-        }
-        else if (offset + len1 == packetLength)
-        {
-            found = true;
-            break;
-        }
-        else
-        {
-            offset += len1;
-        }
-
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
+#ifdef __APPLE__
+    case TransportDummy:
+        length = static_cast<DummyDataController*>(m_serial)->DummyDataController::readPacket(packet, m_responsePolls * 100);
+        break;
+#else
+    case TransportSerial:
+        length = static_cast<SerialDataController*>(m_serial)->SerialDataController::readPacket(packet, m_responsePolls * 100);
+        break;
+    case TransportUDP:
+        length = static_cast<UDPDataController*>(m_serial)->UDPDataController::readPacket(packet, m_responsePolls * 100);
+        break;
+#endif
+#if !defined(__APPLE__) && !defined(__WINDOWS__)
+    case TransportSocket:
+        length = static_cast<SocketDataController*>(m_serial)->SocketDataController::readPacket(packet, m_responsePolls * 100);
+        break;
+#endif
+    default:
+        length = m_serial->readPacket(packet, m_responsePolls * 100);
+        break;
     }
 
-    if (!found)
-    {
-        fprintf(stderr, "DVController::getResponse: Timeout (packet header)\n");
+    if (length <= 0) {
         return RESP_ERROR;
     }
 
-    packetLength = buffer[1] * 256 + buffer[2];
-    packetType = buffer[3];
-    offset = 0;
-    found = false;
-
-    for (int i = 0; i < 2000; i++)
-    {
-        int len1 = m_serial->read(&buffer[4 + offset], packetLength - offset);
-
-        if (len1 < 0)
-        {
-            fprintf(stderr, "DVController::getResponse: Error (packet payload at %d)\n", offset);
-            return RESP_ERROR;
-        }
-        else if (offset + len1 == packetLength)
-        {
-            found = true;
-            break;
-        }
-        else
-        {
-            offset += len1;
-        }
-
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    if (packet.length < DV3000_HEADER_LEN + 1) {
+        return RESP_UNKNOWN;
     }
 
-    if (!found) {
-        fprintf(stderr, "DVController::getResponse: Timeout (packet payload)\n");
-        return RESP_ERROR;
-    }
+    const unsigned char *buffer = packet.data;
+    unsigned char packetType = buffer[3];
 
     //fprintf(stderr, "DVController::getResponse: packet type %02x\n", packetType);
 
@@ -603,9 +1265,13 @@ DVController::RESP_TYPE DVController::getResponse(unsigned char* buffer, unsigne
         {
             return RESP_GAIN;
         }
+        else if (buffer[4] == DV3000_CONTROL_COMPAND)
+        {
+            return RESP_COMPAND;
+        }
         else if (buffer[4] == DV3000_CONTROL_READY)
         {
-            return RESP_UNKNOWN;
+            return RESP_READY;
         }
         else
         {
@@ -618,5 +1284,27 @@ DVController::RESP_TYPE DVController::getResponse(unsigned char* buffer, unsigne
     }
 }
 
+int DVController::writePacket(const unsigned char* packet, unsigned int length)
+{
+    switch (m_transportType)
+    {
+#ifdef __APPLE__
+    case TransportDummy:
+        return static_cast<DummyDataController*>(m_serial)->DummyDataController::writePacket(packet, length);
+#else
+    case TransportSerial:
+        return static_cast<SerialDataController*>(m_serial)->SerialDataController::writePacket(packet, length);
+    case TransportUDP:
+        return static_cast<UDPDataController*>(m_serial)->UDPDataController::writePacket(packet, length);
+#endif
+#if !defined(__APPLE__) && !defined(__WINDOWS__)
+    case TransportSocket:
+        return static_cast<SocketDataController*>(m_serial)->SocketDataController::writePacket(packet, length);
+#endif
+    default:
+        return m_serial->writePacket(packet, length);
+    }
+}
+
 } // namespace SerialDV
 
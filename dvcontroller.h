@@ -20,11 +20,17 @@
 #include <string>
 
 #include "serialdv_export.h"
+#include "datacontroller.h"
+#include "companding.h"
+#include "realtimethread.h"
+#include "tracering.h"
 
 namespace SerialDV
 {
 
 class DataController;
+class DecodeCache;
+class SilenceDetector;
 
 const unsigned int MBE_AUDIO_BLOCK_SIZE  = 160U;
 const unsigned int MBE_AUDIO_BLOCK_BYTES = MBE_AUDIO_BLOCK_SIZE * 2U;
@@ -40,10 +46,15 @@ const unsigned char DV3000_CONTROL_RATEP  = 0x0AU;
 const unsigned char DV3000_CONTROL_GAIN   = 0x4BU;
 const unsigned char DV3000_CONTROL_PRODID = 0x30U;
 const unsigned char DV3000_CONTROL_READY  = 0x39U;
+const unsigned char DV3000_CONTROL_COMPAND = 0x32U;
+const unsigned char DV3000_CONTROL_RESET  = 0x33U;
 
 const unsigned char DV3000_REQ_PRODID[] = {DV3000_START_BYTE, 0x00U, 0x01U, DV3000_TYPE_CONTROL, DV3000_CONTROL_PRODID};
 const unsigned int DV3000_REQ_PRODID_LEN = 5U;
 
+const unsigned char DV3000_REQ_RESET[] = {DV3000_START_BYTE, 0x00U, 0x01U, DV3000_TYPE_CONTROL, DV3000_CONTROL_RESET}; // answered by READY
+const unsigned int DV3000_REQ_RESET_LEN = 5U;
+
 const unsigned char DV3000_REQ_3600X2400_RATEP[]   = {DV3000_START_BYTE, 0x00U, 0x0DU, DV3000_TYPE_CONTROL, DV3000_CONTROL_RATEP, 0x01U, 0x30U, 0x07U, 0x63U, 0x40U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x48U};
 const unsigned char DV3000_REQ_3600X2450_RATEP[]   = {DV3000_START_BYTE, 0x00U, 0x0DU, DV3000_TYPE_CONTROL, DV3000_CONTROL_RATEP, 0x04U, 0x31U, 0x07U, 0x54U, 0x24U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x6FU, 0x48U};
 
@@ -66,9 +77,14 @@ const unsigned int DV3000_REQ_RATEP_LEN = 17U;
 const unsigned char DV3000_REQ_GAIN[] = {DV3000_START_BYTE, 0x00U, 0x03U, DV3000_TYPE_CONTROL, DV3000_CONTROL_GAIN}; // followed by 1 byte input gain and 1 byte output gain
 const unsigned int DV3000_REQ_GAIN_LEN = 5U;
 
-const unsigned char DV3000_AUDIO_HEADER[] = {DV3000_START_BYTE, 0x01U, 0x42U, DV3000_TYPE_AUDIO, 0x00U, 0xA0U};
+constexpr unsigned char DV3000_AUDIO_HEADER[] = {DV3000_START_BYTE, 0x01U, 0x42U, DV3000_TYPE_AUDIO, 0x00U, 0xA0U};
 const unsigned char DV3000_AUDIO_HEADER_LEN = 6U;
 
+const unsigned char DV3000_REQ_COMPAND[] = {DV3000_START_BYTE, 0x00U, 0x02U, DV3000_TYPE_CONTROL, DV3000_CONTROL_COMPAND}; // followed by 1 byte: b0 enable, b1 A-law
+const unsigned int DV3000_REQ_COMPAND_LEN = 5U;
+
+constexpr unsigned char DV3000_COMPANDED_AUDIO_HEADER[] = {DV3000_START_BYTE, 0x00U, 0xA2U, DV3000_TYPE_AUDIO, 0x00U, 0xA0U}; // 160 8 bit samples
+
 const unsigned char DV3000_AMBE_HEADER[] = {DV3000_START_BYTE, 0x00U, 0x0BU, DV3000_TYPE_AMBE, 0x01U, 0x48U};
 const unsigned char DV3000_AMBE_HEADER_LEN  = 6U;
 
@@ -92,16 +108,109 @@ typedef enum
     DVRate9600
 } DVRate;
 
+const unsigned int DV_NB_RATES = DVRate9600 + 1;
+
+/** Everything the controller needs to know about a rate
+ */
+struct DVRateDescriptor
+{
+    DVRate rate;
+    unsigned char nbBits;       //!< number of bits in a MBE frame
+    unsigned short nbBytes;     //!< number of bytes in a MBE frame
+    const unsigned char *ratep; //!< RATEP request packet of DV3000_REQ_RATEP_LEN bytes or nullptr if the rate is not mapped
+    unsigned char ambeHeader[DV3000_AMBE_HEADER_LEN]; //!< AMBE packet header with length and CHAND number of bits set
+};
+
+/** Rate descriptors indexed by DVRate. Mapping a new rate is a matter of filling its line.
+ */
+constexpr DVRateDescriptor DV_RATE_DESCRIPTORS[DV_NB_RATES] = {
+    {DVRateNone,        0,   0, nullptr,                      {DV3000_START_BYTE, 0x00U, 0x02U, DV3000_TYPE_AMBE, 0x01U, 0x00U}},
+    {DVRate3600x2400,  72,   9, DV3000_REQ_3600X2400_RATEP,   {DV3000_START_BYTE, 0x00U, 0x0BU, DV3000_TYPE_AMBE, 0x01U, 0x48U}},
+    {DVRate3600x2450,  72,   9, DV3000_REQ_3600X2450_RATEP,   {DV3000_START_BYTE, 0x00U, 0x0BU, DV3000_TYPE_AMBE, 0x01U, 0x48U}},
+    {DVRate7200x4400, 144,  18, DV3000_REQ_7200X4400_3_RATEP, {DV3000_START_BYTE, 0x00U, 0x14U, DV3000_TYPE_AMBE, 0x01U, 0x90U}}, // AMBE 3000 version
+    {DVRate7100x4400,   0,   0, nullptr,                      {DV3000_START_BYTE, 0x00U, 0x02U, DV3000_TYPE_AMBE, 0x01U, 0x00U}},
+    {DVRate2400,        0,   0, nullptr,                      {DV3000_START_BYTE, 0x00U, 0x02U, DV3000_TYPE_AMBE, 0x01U, 0x00U}},
+    {DVRate2450,       49,   7, DV3000_REQ_2450_RATEP,        {DV3000_START_BYTE, 0x00U, 0x09U, DV3000_TYPE_AMBE, 0x01U, 0x31U}},
+    {DVRate4400,       88,  11, DV3000_REQ_4400_RATEP,        {DV3000_START_BYTE, 0x00U, 0x0DU, DV3000_TYPE_AMBE, 0x01U, 0x58U}},
+    {DVRate2200,       44,   6, DV3000_REQ_2200_RATEP,        {DV3000_START_BYTE, 0x00U, 0x08U, DV3000_TYPE_AMBE, 0x01U, 0x2CU}},
+    {DVRate3000,       60,   8, DV3000_REQ_3000_RATEP,        {DV3000_START_BYTE, 0x00U, 0x0AU, DV3000_TYPE_AMBE, 0x01U, 0x3CU}},
+    {DVRate6400,      128,  16, DV3000_REQ_6400_RATEP,        {DV3000_START_BYTE, 0x00U, 0x12U, DV3000_TYPE_AMBE, 0x01U, 0x80U}},
+    {DVRate7200,      144,  18, DV3000_REQ_7200_RATEP,        {DV3000_START_BYTE, 0x00U, 0x14U, DV3000_TYPE_AMBE, 0x01U, 0x90U}},
+    {DVRate8000,      160,  20, DV3000_REQ_8000_RATEP,        {DV3000_START_BYTE, 0x00U, 0x16U, DV3000_TYPE_AMBE, 0x01U, 0xA0U}},
+    {DVRate9600,      192,  24, DV3000_REQ_9600_RATEP,        {DV3000_START_BYTE, 0x00U, 0x1AU, DV3000_TYPE_AMBE, 0x01U, 0xC0U}}
+};
+
+/** Timing of the device link and pipelining depth derived from it
+ */
+struct DVPipelineStats
+{
+    unsigned int rttUs;            //!< smoothed time from sending a frame to its response
+    unsigned int baseRttUs;        //!< round trip time without queueing in the device
+    unsigned int serviceUs;        //!< time between responses when the device is kept busy
+    unsigned int window;           //!< number of frames to keep in flight
+    unsigned int batch;            //!< number of frames to submit at once
+    unsigned int latencyCeilingUs;
+};
+
 class SERIALDV_API DVController
 {
 public:
 	DVController();
 	~DVController();
 
+    /** Open the device. If the device identity is known from a previous open or a discovery
+     * (see DVDiscovery) the product identification round trip is skipped.
+     */
     bool open(const std::string& device, bool halfSpeed=false);
+    /** Open the device through the given transport (ex: RecordingDataController, ReplayDataController)
+     * which is then owned by the controller. The device is always identified.
+     */
+    bool open(DataController *dataController, const std::string& device, bool halfSpeed=false);
     void close();
+    /** Transport used for a device name: unix:/path or tcp://host:port for a stream socket,
+     * UDP if it contains a port (ip:port) else serial
+     */
+    static DataController *createDataController(const std::string& device);
     bool isOpen() const { return m_open; }
 
+    /** Product identification string of the opened device
+     */
+    const std::string& getProductId() const { return m_productId; }
+
+    /** Maximum time to wait for each part of a device response. Default is 200 ms
+     */
+    void setResponseTimeout(unsigned int timeoutMs);
+
+    /** Enable or disable automatic recovery from device faults. When a transaction fails the
+     * controller resynchronizes on the packet stream, then resets the device, then reopens it
+     * until the device answers again. The rate, gain and companding in use are then restored
+     * and the failed frame is processed again.
+     */
+    void setAutoRecovery(bool autoRecovery) { m_autoRecovery = autoRecovery; }
+    unsigned long long getNbRecoveries() const { return m_nbRecoveries; }
+    unsigned long long getNbFailedRecoveries() const { return m_nbFailedRecoveries; }
+
+    /** Start real time mode: device I/O of encode() and decode() is done in a dedicated
+     * thread that can be pinned to a CPU, scheduled with SCHED_FIFO and, if requested, have
+     * the process memory locked and its stack pre-faulted. FTDI latency_timer is set to 1 ms if permitted.
+     * Must be called after open(). Returns what could actually be applied.
+     */
+    RealTimeStatus startRealTime(const RealTimeConfig& config = RealTimeConfig());
+    void stopRealTime();
+    RealTimeStatus getRealTimeStatus() const;
+
+    /** Record protocol events of the device in a ring of the given capacity (0 disables).
+     * The ring can be saved with getTrace()->save() and converted with the dvtrace tool.
+     * Not to be called while encode() or decode() is running.
+     */
+    void setTrace(unsigned int capacity);
+    TraceRing *getTrace() { return m_trace; }
+
+    /** Forget the known identity of a device (all devices if empty) so that next open() probes it again
+     */
+    static void clearIdentityCache(const std::string& device = std::string());
+    DVRate getCurrentRate() const { return m_currentRate; }
+
 	/** Encoding process of one audio frame to one AMBE frame
 	 * Buffers are supposed to be allocated with the correct size. That is
 	 * - 320 bytes (160 short samples) for the audio frame.
@@ -122,6 +231,57 @@ public:
 	 */
 	bool decode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain = 0);
 
+    static const unsigned int MAX_IN_FLIGHT = 32U;
+
+    /** Pipelined processing: the frame is sent to the device without waiting for its response so that
+     * several frames are in flight on the link. Results are obtained in submission order with collect().
+     * Buffers must remain valid until the frame is collected. Rate or gain changes are sent in the same
+     * write as the data packet of the frame that needs them and a failed change fails that frame.
+     * Returns false if the pipeline is full or the device is not open.
+     * Synchronous calls complete the frames in flight before using the device, their results are
+     * kept for collect(). As device responses are not tagged a response lost on the link is only
+     * detected when the last frame in flight times out.
+     * In real time mode (see startRealTime()) device I/O of these calls also takes place in the real time thread.
+     */
+    bool submitEncode(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain = 0, void *userData = nullptr);
+    bool submitDecode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain = 0, void *userData = nullptr);
+
+    /** Complete the oldest frame in flight. Returns 1 if it was processed, 0 if it failed and -1 if no
+     * frame is in flight. The userData given at submission is returned in userData if not null.
+     */
+    int collect(void **userData = nullptr);
+    unsigned int getNbInFlight() const { return m_inFlightTail - m_inFlightHead; }
+
+    /** Round trip and service times are measured at identification and on every frame. The window is
+     * set to twice the number of frames needed to keep the device busy (round trip over service time)
+     * within the latency ceiling, and the batch to what is left above that number so that refilling
+     * the window in one go does not starve the device. Default ceiling is 100 ms.
+     * The base round trip is only sampled on frames sent with no other frame in flight. If there
+     * was none for 2 seconds the window is set to 1 until one is obtained.
+     */
+    void setLatencyCeiling(unsigned int latencyUs);
+    unsigned int getInFlightWindow() const { return m_window; }
+    unsigned int getBatchSize() const { return m_batch; }
+    DVPipelineStats getPipelineStats() const;
+
+    /** Same as encode() with the rate known at compile time
+     */
+    template<DVRate Rate>
+    bool encode(const short *audioFrame, unsigned char *mbeFrame, int gain = 0)
+    {
+        static_assert(DV_RATE_DESCRIPTORS[Rate].nbBytes != 0, "rate is not mapped");
+        return encodeRate(audioFrame, mbeFrame, DV_RATE_DESCRIPTORS[Rate], gain);
+    }
+
+    /** Same as decode() with the rate known at compile time
+     */
+    template<DVRate Rate>
+    bool decode(short *audioFrame, const unsigned char *mbeFrame, int gain = 0)
+    {
+        static_assert(DV_RATE_DESCRIPTORS[Rate].nbBytes != 0, "rate is not mapped");
+        return decodeRate(audioFrame, mbeFrame, DV_RATE_DESCRIPTORS[Rate], gain);
+    }
+
 	/** Returns the number of bytes in a MBE frame given the MBE rate
 	 */
 	static unsigned short getNbMbeBytes(DVRate mbeRate);
@@ -130,6 +290,38 @@ public:
      */
     static unsigned char getNbMbeBits(DVRate mbeRate);
 
+    /** Enable decoded frame cache with given maximum number of entries. 0 disables it.
+     * Repeated frames (silence, idle...) are then decoded without a device round trip.
+     */
+    void setDecodeCache(unsigned int maxEntries);
+
+    /** Returns the decoded frame cache (statistics) or nullptr if disabled
+     */
+    const DecodeCache *getDecodeCache() const { return m_decodeCache; }
+
+    /** Select companded (8 bit µ-law or A-law) or linear (16 bit) speech samples between host and device.
+     * Companded samples halve the audio packets size on the link. The API remains with 16 bit samples
+     * as conversion is done on the host. If the device is not open yet this is applied at open time.
+     */
+    bool setCompanding(DVCompanding companding);
+    DVCompanding getCompanding() const { return m_companding; }
+
+    /** Enable or disable host side silence detection on encoding.
+     * Audio frames with an energy below thresholdDb (relative to full scale) are not sent to the
+     * device and the silence AMBE frame of the rate is returned instead. Detection starts only
+     * after hangoverFrames consecutive frames below threshold so that speech is not clipped.
+     */
+    void setSilenceDetection(bool enable, float thresholdDb = -60.0f, unsigned int hangoverFrames = 10);
+
+    /** Returns the silence detector (statistics) or nullptr if disabled
+     */
+    const SilenceDetector *getSilenceDetector() const { return m_silenceDetector; }
+
+    /** Set the AMBE frame returned for silent frames at the given rate.
+     * If not set it is obtained from the device by encoding digital silence the first time it is needed.
+     */
+    void setSilenceFrame(DVRate rate, const unsigned char *mbeFrame);
+
 private:
 
     enum RESP_TYPE {
@@ -140,32 +332,134 @@ private:
         RESP_AMBE,
         RESP_AUDIO,
         RESP_GAIN,
+        RESP_COMPAND,
+        RESP_READY,
         RESP_UNKNOWN
     };
 
     DataController *m_serial;
+    DecodeCache *m_decodeCache;
+    SilenceDetector *m_silenceDetector;
+    unsigned char m_silenceFrames[DV_NB_RATES][MBE_FRAME_MAX_LENGTH_BYTES_INTERNAL];
+    bool m_silenceFrameValid[DV_NB_RATES];
     bool m_open; //!< True if the serial DV device has been correctly opened
+    std::string m_device;
+    bool m_halfSpeed;
+    std::string m_productId;
+    unsigned int m_responsePolls; //!< number of 100 us polls before response timeout
     DVRate m_currentRate;
     int m_currentGainIn;
     int m_currentGainOut;
-    unsigned char m_currentNbMbeBits;
-    unsigned short m_currentNbMbeBytes;
-    bool m_littleEndian;
+    bool m_gainKnown;           //!< false when the last gain packet failed: gain is sent with the next frame
+    const DVRateDescriptor *m_currentDescriptor; //!< last rate set in the device
+    DVCompanding m_companding;
+    RealTimeThread *m_realTimeThread;
+    bool m_latencyTimerSet;
+    bool m_autoRecovery;
+    unsigned long long m_nbRecoveries;
+    unsigned long long m_nbFailedRecoveries;
+    TraceRing *m_trace;
+
+    /** Concrete type of the transport for static dispatch */
+    typedef enum
+    {
+        TransportGeneric,
+        TransportSerial,
+        TransportUDP,
+        TransportSocket,
+        TransportDummy
+    } TransportType;
+
+    TransportType m_transportType;
+    bool m_datagram;            //!< transport sends each write as one datagram
 
-    bool isLittleEndian()
+    struct InFlightFrame
     {
-        short int number = 0x1;
-        char *numPtr = (char*)&number;
-        return (numPtr[0] == 1);
-    }
+        bool encode;
+        const short *audioIn;
+        unsigned char *mbeOut;
+        short *audioOut;
+        const unsigned char *mbeIn;
+        const DVRateDescriptor *rate;
+        int gain;
+        void *userData;
+        bool completed;
+        bool result;
+        bool alone;          //!< no other frame in flight when sent
+        uint64_t submitNs;
+        const DVRateDescriptor *descriptor; //!< rate of the device when sent
+        unsigned char controls;             //!< control packets sent before the data packet
+    };
+
+    static const unsigned char CONTROL_RATEP = 0x01U;
+    static const unsigned char CONTROL_GAIN  = 0x02U;
+
+    InFlightFrame m_inFlight[MAX_IN_FLIGHT];
+    unsigned int m_inFlightHead;  //!< oldest frame not collected
+    unsigned int m_inFlightRead;  //!< oldest frame whose response is not read
+    unsigned int m_inFlightTail;
+    double m_rttUs;
+    double m_baseRttUs;
+    double m_serviceUs;
+    uint64_t m_lastResponseNs;
+    uint64_t m_lastAloneNs;        //!< last base round trip sample
+    unsigned int m_latencyCeilingUs;
+    unsigned int m_window;
+    unsigned int m_batch;
+
+    struct FrameJob
+    {
+        DVController *controller;
+        const short *audioIn;
+        unsigned char *mbeOut;
+        short *audioOut;
+        const unsigned char *mbeIn;
+        const DVRateDescriptor *rate;
+        int gain;
+        bool result;
+    };
+
+    struct PipelineJob
+    {
+        DVController *controller;
+        const InFlightFrame *frame;   //!< frame to submit or nullptr to collect
+        void **userData;
+        int result;
+    };
 
-    void encodeIn(const short* audio, unsigned int length);
-    bool encodeOut(unsigned char* ambe, unsigned int length);
+    bool encodeRate(const short *audioFrame, unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain);
+    bool decodeRate(short *audioFrame, const unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain);
+    bool processEncode(const short *audioFrame, unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain);
+    bool processDecode(short *audioFrame, const unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain);
+    static void runEncodeJob(void *arg);
+    static void runDecodeJob(void *arg);
+    static void runSubmitJob(void *arg);
+    static void runCollectJob(void *arg);
+    bool encodeFrame(const short *audioFrame, unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain);
+    bool encodeTransaction(const short *audioFrame, unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain);
+    bool decodeFrame(short *audioFrame, const unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain);
+    bool decodeTransaction(short *audioFrame, const unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain);
+    bool getSilenceFrame(unsigned char *mbeFrame, const DVRateDescriptor& rate, int gain);
+    bool submitFrame(const InFlightFrame& frame);
+    bool processSubmit(const InFlightFrame& frame);
+    int processCollect(void **userData);
+    void sendFrame(InFlightFrame& frame);
+    bool receiveResponses(InFlightFrame& frame);
+    bool receiveFrame(InFlightFrame& frame);
+    void receiveInFlight(unsigned int end);
+    void flushInFlight() { receiveInFlight(m_inFlightTail); }
+    void updateTiming(uint64_t sentNs, bool alone, bool queued);
+    InFlightFrame& inFlightFrame(unsigned int index) { return m_inFlight[index % MAX_IN_FLIGHT]; }
+
+    /** Build the data packet in buffer and return its length
+     */
+    unsigned int encodeIn(const short* audio, unsigned char *buffer);
+    bool encodeOut(unsigned char* ambe, const DVRateDescriptor& rate);
 
-    void decodeIn(const unsigned char* ambe, unsigned char nbBits, unsigned short nbBytes);
+    unsigned int decodeIn(const unsigned char* ambe, const DVRateDescriptor& rate, unsigned char *buffer);
     bool decodeOut(short* audio, unsigned int length);
 
-    bool setRate(DVRate rate);
+    bool setRate(const DVRateDescriptor& rate);
 
     /** Set input and output gain in dB (-90 to +90 dB)
      * If the input gain is < 0 dB then the input speech samples are attenuated prior to encoding.
@@ -174,8 +468,28 @@ private:
      * If the output gain is > 0 dB then the output speech samples are amplified after decoding.
      */
     bool setGain(signed char dBGainIn, signed char dBGainOut);
+    static unsigned int gainPacket(signed char dBGainIn, signed char dBGainOut, unsigned char *packet);
+
+    bool sendCompanding();
 
-    RESP_TYPE getResponse(unsigned char* buffer, unsigned int length);
+    bool openTransport(DataController *dataController, const std::string& device, bool halfSpeed, bool useIdentityCache);
+    bool identify();
+    bool recover();
+    void drain();
+    bool softReset();
+    bool reopen();
+    bool reconfigure();
+
+    RESP_TYPE getResponse(PacketView& packet);
+    int writePacket(const unsigned char* packet, unsigned int length);
+    static TransportType getTransportType(DataController *dataController);
+
+    void traceEvent(TraceEventType type, uint32_t value = 0)
+    {
+        if (m_trace) {
+            m_trace->record(type, TraceRing::NO_PACKET_TYPE, 0, value);
+        }
+    }
 };
 
 } // namespace SerialDV
@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <thread>
+#include <algorithm>
+
+#if !defined(__WINDOWS__)
+#include <glob.h>
+#endif
+
+#include "dvcontroller.h"
+#include "dvdiscovery.h"
+
+namespace SerialDV
+{
+
+std::vector<std::string> DVDiscovery::enumerateSerialDevices()
+{
+    std::vector<std::string> devices;
+#if !defined(__WINDOWS__)
+    const char *patterns[] = {"/dev/ttyUSB*", "/dev/ttyACM*"};
+
+    for (unsigned int i = 0; i < sizeof(patterns)/sizeof(patterns[0]); i++)
+    {
+        glob_t globResult;
+
+        if (::glob(patterns[i], 0, nullptr, &globResult) == 0)
+        {
+            for (size_t j = 0; j < globResult.gl_pathc; j++) {
+                devices.push_back(globResult.gl_pathv[j]);
+            }
+        }
+
+        ::globfree(&globResult);
+    }
+#endif
+    return devices;
+}
+
+std::vector<DVDeviceInfo> DVDiscovery::probe(const std::vector<std::string>& devices, unsigned int timeoutMs, bool halfSpeed)
+{
+    std::vector<DVDeviceInfo> results(devices.size());
+    std::vector<std::thread> threads;
+
+    for (unsigned int i = 0; i < devices.size(); i++)
+    {
+        results[i].device = devices[i];
+        threads.push_back(std::thread([&results, i, timeoutMs, halfSpeed]()
+        {
+            DVController controller;
+            controller.setResponseTimeout(timeoutMs);
+            DVController::clearIdentityCache(results[i].device); // really probe
+
+            if (controller.open(results[i].device, halfSpeed))
+            {
+                results[i].productId = controller.getProductId();
+                controller.close();
+            }
+        }));
+    }
+
+    for (unsigned int i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+
+    results.erase(std::remove_if(results.begin(), results.end(),
+        [](const DVDeviceInfo& info) { return info.productId.empty(); }), results.end());
+
+    return results;
+}
+
+std::vector<DVDeviceInfo> DVDiscovery::discover(const std::vector<std::string>& udpServers, unsigned int timeoutMs, bool halfSpeed)
+{
+    std::vector<std::string> devices = enumerateSerialDevices();
+    devices.insert(devices.end(), udpServers.begin(), udpServers.end());
+    return probe(devices, timeoutMs, halfSpeed);
+}
+
+} // namespace SerialDV
@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DVDISCOVERY_H_
+#define DVDISCOVERY_H_
+
+#include <string>
+#include <vector>
+
+#include "serialdv_export.h"
+
+namespace SerialDV
+{
+
+struct DVDeviceInfo
+{
+    std::string device;    //!< TTY device or UDP address:port
+    std::string productId; //!< product identification returned by the device (empty if not identified)
+};
+
+/** Find DV3000 devices by probing all candidates concurrently
+ */
+class SERIALDV_API DVDiscovery
+{
+public:
+    /** List serial devices that could be DV3000 devices i.e. /dev/ttyUSB* and /dev/ttyACM*
+     */
+    static std::vector<std::string> enumerateSerialDevices();
+
+    /** Probe the given devices concurrently and return the ones that identified themselves.
+     * Each probe waits at most timeoutMs for the device to answer. Devices are always probed and identified ones are
+     * remembered so that a later DVController::open() on them does not probe again.
+     */
+    static std::vector<DVDeviceInfo> probe(const std::vector<std::string>& devices, unsigned int timeoutMs = 100, bool halfSpeed = false);
+
+    /** Probe all enumerated serial devices plus the given UDP servers (address:port)
+     */
+    static std::vector<DVDeviceInfo> discover(const std::vector<std::string>& udpServers = std::vector<std::string>(), unsigned int timeoutMs = 100, bool halfSpeed = false);
+};
+
+} // namespace SerialDV
+
+#endif /* DVDISCOVERY_H_ */
@@ -0,0 +1,251 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+// Checks the length of the packets sent to the device for every mapped rate against
+// the rate descriptors and the rejection of responses of the wrong length. Exits with
+// a non zero status on failure.
+
+#include <stdio.h>
+#include <string.h>
+#include <deque>
+#include <vector>
+
+#include "datacontroller.h"
+#include "dvcontroller.h"
+#include "logger.h"
+
+/** Answers like an AMBE3000 with the last written packets kept for inspection.
+ * The next response can be given a wrong number of samples or bits.
+ */
+class PacketTestController : public SerialDV::DataController
+{
+public:
+    std::vector<std::vector<unsigned char> > written;
+    int nbSamples;   //!< SPEECHD field and samples of the next audio response
+    int nbBits;      //!< CHAND field of the next AMBE response, -1 for the one of the request
+    int nbBytes;     //!< bytes of the next AMBE response
+
+    PacketTestController() : nbSamples(160), nbBits(-1), nbBytes(9) {}
+
+    virtual bool open(const std::string&, SerialDV::SERIAL_SPEED) { return true; }
+    virtual bool initResponse() { return !m_responses.empty(); }
+    virtual void closeIt() {}
+
+    virtual int read(unsigned char* buffer, unsigned int lengthInBytes)
+    {
+        unsigned int i = 0;
+
+        for (; (i < lengthInBytes) && !m_responses.empty(); i++)
+        {
+            buffer[i] = m_responses.front();
+            m_responses.pop_front();
+        }
+
+        return i;
+    }
+
+    virtual int write(const unsigned char* buffer, unsigned int lengthInBytes)
+    {
+        for (unsigned int offset = 0; offset + 4 <= lengthInBytes; )
+        {
+            unsigned int length = 4 + buffer[offset + 1]*256 + buffer[offset + 2];
+            length = offset + length > lengthInBytes ? lengthInBytes - offset : length;
+            written.push_back(std::vector<unsigned char>(buffer + offset, buffer + offset + length));
+            respond(written.back());
+            offset += length;
+        }
+
+        return lengthInBytes;
+    }
+
+private:
+    std::deque<unsigned char> m_responses;
+
+    void respond(const std::vector<unsigned char>& packet)
+    {
+        std::vector<unsigned char> response;
+
+        if (packet[3] == 0x00) // control
+        {
+            if (packet[4] == 0x30) {
+                const unsigned char prodId[] = {0x61, 0x00, 0x0B, 0x00, 0x30, 'A', 'M', 'B', 'E', '3', '0', '0', '0', 'R', 0};
+                response.assign(prodId, prodId + sizeof(prodId));
+            } else if (packet[4] == 0x33) {
+                const unsigned char ready[] = {0x61, 0x00, 0x01, 0x00, 0x39};
+                response.assign(ready, ready + sizeof(ready));
+            } else {
+                const unsigned char ok[] = {0x61, 0x00, 0x02, 0x00, packet[4], 0x00};
+                response.assign(ok, ok + sizeof(ok));
+            }
+        }
+        else if (packet[3] == 0x02) // audio to encode
+        {
+            unsigned int length = 2 + nbBytes;
+            unsigned char header[] = {0x61, (unsigned char) (length >> 8), (unsigned char) length, 0x01, 0x01,
+                (unsigned char) (nbBits < 0 ? nbBytes*8 : nbBits)};
+            response.assign(header, header + sizeof(header));
+            response.resize(response.size() + nbBytes, 0x55);
+            nbBits = -1;
+            nbBytes = 9;
+        }
+        else if (packet[3] == 0x01) // AMBE frame to decode
+        {
+            unsigned int length = 2 + 2*nbSamples;
+            unsigned char header[] = {0x61, (unsigned char) (length >> 8), (unsigned char) length, 0x02, 0x00, (unsigned char) nbSamples};
+            response.assign(header, header + sizeof(header));
+            response.resize(response.size() + 2*nbSamples, 0x00);
+            nbSamples = 160;
+        }
+
+        m_responses.insert(m_responses.end(), response.begin(), response.end());
+    }
+};
+
+static int nbFailures = 0;
+
+static void check(bool condition, const char *what)
+{
+    fprintf(stderr, "%s: %s\n", condition ? "OK  " : "FAIL", what);
+    nbFailures += condition ? 0 : 1;
+}
+
+static unsigned int declaredLength(const std::vector<unsigned char>& packet)
+{
+    return 4 + packet[1]*256 + packet[2];
+}
+
+/** Last written control packet with the given field or an empty packet
+ */
+static std::vector<unsigned char> findControl(const std::vector<std::vector<unsigned char> >& written, unsigned char field)
+{
+    for (unsigned int i = written.size(); i > 0; i--)
+    {
+        if ((written[i-1].size() > 4) && (written[i-1][3] == SerialDV::DV3000_TYPE_CONTROL) && (written[i-1][4] == field)) {
+            return written[i-1];
+        }
+    }
+
+    return std::vector<unsigned char>();
+}
+
+int main()
+{
+    SerialDV::Logger::setLevel(SerialDV::LogNone);
+    PacketTestController *transport = new PacketTestController();
+    SerialDV::DVController controller;
+
+    if (!controller.open(transport, "test"))
+    {
+        fprintf(stderr, "FAIL: open\n");
+        return 1;
+    }
+
+    controller.setAutoRecovery(false);
+    short audio[SerialDV::MBE_AUDIO_BLOCK_SIZE];
+    unsigned char mbe[SerialDV::MBE_FRAME_MAX_LENGTH_BYTES];
+    memset(audio, 0, sizeof(audio));
+    memset(mbe, 0, sizeof(mbe));
+
+    // encoded audio packet: header, SPEECHD field id, number of samples, 160 big endian samples
+    transport->written.clear();
+    check(controller.encode(audio, mbe, SerialDV::DVRate3600x2450), "encode");
+    const std::vector<unsigned char>& audioPacket = transport->written.back();
+    check(audioPacket.size() == 6 + 2*SerialDV::MBE_AUDIO_BLOCK_SIZE, "audio packet is 326 bytes");
+    check(declaredLength(audioPacket) == audioPacket.size(), "audio packet length field");
+    check(audioPacket[5] == SerialDV::MBE_AUDIO_BLOCK_SIZE, "audio packet has 160 samples");
+
+    // AMBE packets and rate changes of every mapped rate: header, CHAND field id, number of bits, frame
+    for (unsigned int i = 0; i < SerialDV::DV_NB_RATES; i++)
+    {
+        const SerialDV::DVRateDescriptor& descriptor = SerialDV::DV_RATE_DESCRIPTORS[i];
+
+        if (descriptor.ratep == nullptr) {
+            continue;
+        }
+
+        SerialDV::DVRate rate = descriptor.rate;
+        unsigned int nbBytes = SerialDV::DVController::getNbMbeBytes(rate);
+        unsigned int nbBits = SerialDV::DVController::getNbMbeBits(rate);
+        char what[80];
+
+        snprintf(what, sizeof(what), "rate %u: descriptor index", i);
+        check(rate == (SerialDV::DVRate) i, what);
+        snprintf(what, sizeof(what), "rate %u: %u bits fit in %u bytes", i, nbBits, nbBytes);
+        check((nbBits != 0) && (nbBytes == (nbBits + 7) / 8), what);
+
+        transport->written.clear();
+        snprintf(what, sizeof(what), "rate %u: decode", i);
+        check(controller.decode(audio, mbe, rate), what);
+        const std::vector<unsigned char>& ambePacket = transport->written.back();
+        snprintf(what, sizeof(what), "rate %u: AMBE packet is %u bytes", i, 6 + nbBytes);
+        check(ambePacket.size() == 6 + nbBytes, what);
+        snprintf(what, sizeof(what), "rate %u: AMBE packet length field", i);
+        check(declaredLength(ambePacket) == ambePacket.size(), what);
+        snprintf(what, sizeof(what), "rate %u: AMBE packet has %u bits", i, nbBits);
+        check(ambePacket[5] == nbBits, what);
+
+        std::vector<unsigned char> ratepPacket = findControl(transport->written, SerialDV::DV3000_CONTROL_RATEP);
+        snprintf(what, sizeof(what), "rate %u: RATEP packet is %u bytes", i, SerialDV::DV3000_REQ_RATEP_LEN);
+        check(ratepPacket.size() == SerialDV::DV3000_REQ_RATEP_LEN, what);
+        snprintf(what, sizeof(what), "rate %u: RATEP packet length field", i);
+        check(!ratepPacket.empty() && (declaredLength(ratepPacket) == ratepPacket.size()), what);
+
+        // the response to an encode must have the length of the rate
+        transport->nbBytes = nbBytes;
+        transport->nbBits = nbBits;
+        snprintf(what, sizeof(what), "rate %u: encode", i);
+        check(controller.encode(audio, mbe, rate), what);
+    }
+
+    // gain change: GAIN field id, input gain, output gain
+    transport->written.clear();
+    check(controller.decode(audio, mbe, SerialDV::DVRate3600x2450, 3), "decode with gain");
+    std::vector<unsigned char> gainPacket = findControl(transport->written, SerialDV::DV3000_CONTROL_GAIN);
+    check(gainPacket.size() == SerialDV::DV3000_REQ_GAIN_LEN + 2, "GAIN packet is 7 bytes");
+    check(!gainPacket.empty() && (declaredLength(gainPacket) == gainPacket.size()), "GAIN packet length field");
+
+    // companded audio: COMPAND field id and mode, then 160 8 bit samples
+    transport->written.clear();
+    check(controller.setCompanding(SerialDV::DVCompandingULaw), "set companding");
+    std::vector<unsigned char> compandPacket = findControl(transport->written, SerialDV::DV3000_CONTROL_COMPAND);
+    check(compandPacket.size() == SerialDV::DV3000_REQ_COMPAND_LEN + 1, "COMPAND packet is 6 bytes");
+    check(!compandPacket.empty() && (declaredLength(compandPacket) == compandPacket.size()), "COMPAND packet length field");
+
+    transport->written.clear();
+    check(controller.encode(audio, mbe, SerialDV::DVRate3600x2450), "companded encode");
+    const std::vector<unsigned char>& compandedPacket = transport->written.back();
+    check(compandedPacket.size() == 6 + SerialDV::MBE_AUDIO_BLOCK_SIZE, "companded audio packet is 166 bytes");
+    check(declaredLength(compandedPacket) == compandedPacket.size(), "companded audio packet length field");
+    check(compandedPacket[5] == SerialDV::MBE_AUDIO_BLOCK_SIZE, "companded audio packet has 160 samples");
+    check(controller.setCompanding(SerialDV::DVCompandingNone), "reset companding");
+
+    // responses of the wrong length are rejected
+    transport->nbSamples = 192;
+    check(!controller.decode(audio, mbe, SerialDV::DVRate3600x2450), "192 samples response rejected");
+    transport->nbSamples = 159;
+    check(!controller.decode(audio, mbe, SerialDV::DVRate3600x2450), "159 samples response rejected");
+    transport->nbBytes = 10;
+    check(!controller.encode(audio, mbe, SerialDV::DVRate3600x2450), "10 bytes AMBE response rejected");
+    transport->nbBits = 49;
+    check(!controller.encode(audio, mbe, SerialDV::DVRate3600x2450), "49 bits AMBE response rejected");
+
+    // and the link is still in step
+    check(controller.decode(audio, mbe, SerialDV::DVRate3600x2450), "decode after rejections");
+    check(controller.encode(audio, mbe, SerialDV::DVRate3600x2450), "encode after rejections");
+
+    controller.close();
+    return nbFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,248 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include "dvsharedclient.h"
+#include "dvsharedmemory.h"
+#include "logger.h"
+
+namespace SerialDV
+{
+
+using namespace SharedMemory;
+
+DVSharedClient::DVSharedClient() :
+    m_segment(nullptr),
+    m_slot(nullptr),
+    m_submitSequence(0),
+    m_collectSequence(0)
+{}
+
+DVSharedClient::~DVSharedClient()
+{
+    detach();
+}
+
+bool DVSharedClient::attach(const std::string& name)
+{
+    detach();
+    int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+
+    if (fd < 0)
+    {
+        SERIALDV_LOG(LogError, "DVSharedClient::attach: no server at %s: %s", name.c_str(), strerror(errno));
+        return false;
+    }
+
+    struct stat status;
+
+    if ((::fstat(fd, &status) < 0) || ((size_t) status.st_size < sizeof(Segment)))
+    {
+        SERIALDV_LOG(LogError, "DVSharedClient::attach: %s is not a server segment", name.c_str());
+        ::close(fd);
+        return false;
+    }
+
+    void *memory = ::mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+
+    m_segment = static_cast<Segment*>(memory);
+
+    if ((m_segment->magic != MAGIC) || (m_segment->version != VERSION) || (m_segment->serverPid.load() == 0))
+    {
+        SERIALDV_LOG(LogError, "DVSharedClient::attach: server at %s is not running", name.c_str());
+        detach();
+        return false;
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    for (unsigned int i = 0; i < NB_SLOTS; i++)
+    {
+        Slot& slot = m_segment->slots[i];
+        uint32_t expected = SlotFree;
+
+        if (slot.state.compare_exchange_strong(expected, SlotClaimed))
+        {
+            slot.requests.head.store(0);
+            slot.requests.tail.store(0);
+            slot.responses.head.store(0);
+            slot.responses.tail.store(0);
+            slot.responseFutex.store(0);
+            slot.clientWaiting.store(0);
+            slot.pid.store(::getpid());
+            slot.device = i % m_segment->nbDevices;
+            slot.state.store(SlotAttached, std::memory_order_release);
+            m_slot = &slot;
+            m_submitSequence = 0;
+            m_collectSequence = 0;
+            return true;
+        }
+    }
+
+    SERIALDV_LOG(LogError, "DVSharedClient::attach: no free slot at %s", name.c_str());
+    detach();
+    return false;
+}
+
+void DVSharedClient::detach()
+{
+    if (m_slot)
+    {
+        // the server may be processing a request of the slot: it frees the slot when done
+        unsigned int device = m_slot->device;
+        m_slot->state.store(SlotDetaching);
+        m_segment->deviceFutex[device].fetch_add(1);
+        futexWake(m_segment->deviceFutex[device]);
+        m_slot = nullptr;
+    }
+
+    if (m_segment)
+    {
+        ::munmap(m_segment, sizeof(Segment));
+        m_segment = nullptr;
+    }
+}
+
+bool DVSharedClient::submit(unsigned int op, const short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain)
+{
+    if (!m_slot || ((unsigned int) rate >= DV_NB_RATES)) {
+        return false;
+    }
+
+    Ring& ring = m_slot->requests;
+    uint32_t head = ring.head.load(std::memory_order_relaxed);
+
+    if (head - ring.tail.load(std::memory_order_acquire) == RING_SIZE) {
+        return false;
+    }
+
+    Frame& frame = ring.frames[head & (RING_SIZE - 1)];
+    frame.sequence = m_submitSequence++;
+    frame.op = op;
+    frame.rate = rate;
+    frame.gain = gain;
+
+    if (op == OpEncode) {
+        memcpy(frame.audio, audioFrame, MBE_AUDIO_BLOCK_BYTES);
+    } else {
+        memcpy(frame.mbe, mbeFrame, DV_RATE_DESCRIPTORS[rate].nbBytes);
+    }
+
+    ring.head.store(head + 1, std::memory_order_release);
+
+    // the server sets its waiting flag before checking the futex so that no wake up is lost
+    unsigned int device = m_slot->device;
+    m_segment->deviceFutex[device].fetch_add(1);
+
+    if (m_segment->deviceWaiting[device].load()) {
+        futexWake(m_segment->deviceFutex[device]);
+    }
+
+    return true;
+}
+
+bool DVSharedClient::submitEncode(const short *audioFrame, DVRate rate, int gain)
+{
+    return submit(OpEncode, audioFrame, nullptr, rate, gain);
+}
+
+bool DVSharedClient::submitDecode(const unsigned char *mbeFrame, DVRate rate, int gain)
+{
+    return submit(OpDecode, nullptr, mbeFrame, rate, gain);
+}
+
+int DVSharedClient::collect(short *audioFrame, unsigned char *mbeFrame, unsigned int timeoutMs)
+{
+    if (!m_slot || (m_collectSequence == m_submitSequence)) {
+        return -1; // nothing to wait for
+    }
+
+    Ring& ring = m_slot->responses;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    while (true)
+    {
+        uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+
+        while (tail == ring.head.load(std::memory_order_acquire))
+        {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+            if (now >= deadline)
+            {
+                m_collectSequence++; // abandon the frame
+                return -1;
+            }
+
+            m_slot->clientWaiting.store(1);
+            uint32_t seen = m_slot->responseFutex.load();
+
+            if (tail == ring.head.load(std::memory_order_acquire)) {
+                futexWait(m_slot->responseFutex, seen, std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() + 1);
+            }
+
+            m_slot->clientWaiting.store(0);
+        }
+
+        const Frame& frame = ring.frames[tail & (RING_SIZE - 1)];
+
+        if (frame.sequence != m_collectSequence)
+        {
+            // late response to a frame abandoned on timeout
+            SERIALDV_LOG(LogWarning, "DVSharedClient::collect: dropped late response %u", frame.sequence);
+            ring.tail.store(tail + 1, std::memory_order_release);
+            continue;
+        }
+
+        if (frame.ok && (frame.rate < DV_NB_RATES))
+        {
+            if ((frame.op == OpEncode) && mbeFrame) {
+                memcpy(mbeFrame, frame.mbe, DV_RATE_DESCRIPTORS[frame.rate].nbBytes);
+            } else if ((frame.op == OpDecode) && audioFrame) {
+                memcpy(audioFrame, frame.audio, MBE_AUDIO_BLOCK_BYTES);
+            }
+        }
+
+        int result = frame.ok ? 1 : 0;
+        ring.tail.store(tail + 1, std::memory_order_release);
+        m_collectSequence++;
+        return result;
+    }
+}
+
+bool DVSharedClient::encode(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain)
+{
+    return submitEncode(audioFrame, rate, gain) && (collect(nullptr, mbeFrame) == 1);
+}
+
+bool DVSharedClient::decode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain)
+{
+    return submitDecode(mbeFrame, rate, gain) && (collect(audioFrame, nullptr) == 1);
+}
+
+} // namespace SerialDV
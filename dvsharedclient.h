@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DVSHAREDCLIENT_H_
+#define DVSHAREDCLIENT_H_
+
+#include <string>
+#include <stdint.h>
+
+#include "serialdv_export.h"
+#include "dvcontroller.h"
+
+namespace SerialDV
+{
+
+namespace SharedMemory
+{
+    struct Segment;
+    struct Slot;
+}
+
+/** Vocoding through the devices of a DVSharedServer running in another local process.
+ * Up to SharedMemory::RING_SIZE (8) frames can be submitted before their results are
+ * collected in the same order. An object is to be used by one thread at a time. Linux only.
+ */
+class SERIALDV_API DVSharedClient
+{
+public:
+    DVSharedClient();
+    ~DVSharedClient();
+
+    bool attach(const std::string& name = "/serialdv");
+    void detach();
+    bool isAttached() const { return m_slot != nullptr; }
+
+    /** Queue a frame. Returns false if the ring is full or not attached
+     */
+    bool submitEncode(const short *audioFrame, DVRate rate, int gain = 0);
+    bool submitDecode(const unsigned char *mbeFrame, DVRate rate, int gain = 0);
+
+    /** Wait for the result of the oldest submitted frame. The AMBE frame of an encode
+     * is written to mbeFrame and the audio of a decode to audioFrame.
+     * Returns 1 on success, 0 if the device failed to process the frame, -1 on timeout.
+     * A frame that timed out is abandoned: its late response is dropped by the next collect
+     */
+    int collect(short *audioFrame, unsigned char *mbeFrame, unsigned int timeoutMs = 1000);
+
+    /** Synchronous versions
+     */
+    bool encode(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain = 0);
+    bool decode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain = 0);
+
+private:
+    SharedMemory::Segment *m_segment;
+    SharedMemory::Slot *m_slot;
+    uint32_t m_submitSequence;  //!< sequence of the next submitted frame
+    uint32_t m_collectSequence; //!< sequence of the frame expected by the next collect
+
+    bool submit(unsigned int op, const short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain);
+};
+
+} // namespace SerialDV
+
+#endif /* DVSHAREDCLIENT_H_ */
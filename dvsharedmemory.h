@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DVSHAREDMEMORY_H_
+#define DVSHAREDMEMORY_H_
+
+// Internal header: layout of the shared memory segment of DVSharedServer and DVSharedClient
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+#include "datacontroller.h"
+#include "dvcontroller.h"
+
+namespace SerialDV
+{
+namespace SharedMemory
+{
+
+const uint32_t MAGIC = 0x53445653; // "SDVS"
+const uint32_t VERSION = 2;
+const unsigned int MAX_DEVICES = 8;
+const unsigned int NB_SLOTS = 32;  //!< maximum number of attached clients
+const unsigned int RING_SIZE = 8;  //!< frames in flight per client, must be a power of 2
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "atomics in shared memory must be lock free");
+
+enum FrameOp
+{
+    OpEncode = 0,
+    OpDecode = 1
+};
+
+enum SlotState
+{
+    SlotFree = 0,
+    SlotClaimed = 1,
+    SlotAttached = 2,
+    SlotDetaching = 3   //!< the client left: freed by the server thread of the device once it no longer serves the slot
+};
+
+struct Frame
+{
+    uint32_t sequence; //!< set by the client on a request and echoed in its response
+    uint32_t op;
+    uint32_t rate;
+    int32_t gain;
+    uint32_t ok;
+    short audio[MBE_AUDIO_BLOCK_SIZE];
+    unsigned char mbe[MBE_FRAME_MAX_LENGTH_BYTES_INTERNAL];
+};
+
+/** Single producer single consumer ring. Indexes increase forever and wrap at 2^32 */
+struct Ring
+{
+    alignas(64) std::atomic<uint32_t> head; //!< written by the producer
+    alignas(64) std::atomic<uint32_t> tail; //!< written by the consumer
+    Frame frames[RING_SIZE];
+};
+
+struct Slot
+{
+    std::atomic<uint32_t> state;
+    std::atomic<int32_t> pid;
+    uint32_t device;
+    std::atomic<uint32_t> responseFutex; //!< bumped by the server when a response is pushed
+    std::atomic<uint32_t> clientWaiting;
+    Ring requests;
+    Ring responses;
+};
+
+struct Segment
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nbDevices;
+    std::atomic<int32_t> serverPid;
+    std::atomic<uint32_t> deviceFutex[MAX_DEVICES];   //!< bumped by clients when a request is pushed
+    std::atomic<uint32_t> deviceWaiting[MAX_DEVICES];
+    Slot slots[NB_SLOTS];
+};
+
+/** Wait while the word equals expected (at most timeoutMs). Returns false on timeout */
+bool futexWait(std::atomic<uint32_t>& word, uint32_t expected, unsigned int timeoutMs);
+void futexWake(std::atomic<uint32_t>& word);
+
+} // namespace SharedMemory
+} // namespace SerialDV
+
+#endif /* DVSHAREDMEMORY_H_ */
@@ -0,0 +1,285 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#include "dvsharedserver.h"
+#include "dvsharedmemory.h"
+#include "dvcontroller.h"
+#include "logger.h"
+
+namespace SerialDV
+{
+
+using namespace SharedMemory;
+
+DVSharedServer::DVSharedServer(const std::string& name, unsigned int mode) :
+    m_name(name),
+    m_mode(mode),
+    m_segment(nullptr),
+    m_stop(false),
+    m_nbFrames(0)
+{}
+
+DVSharedServer::~DVSharedServer()
+{
+    stop();
+}
+
+bool DVSharedServer::start(const std::vector<DVController*>& controllers)
+{
+    if (m_segment || controllers.empty() || (controllers.size() > MAX_DEVICES)) {
+        return false;
+    }
+
+    int fd = createSegment();
+
+    if (fd < 0) {
+        return false;
+    }
+
+    ::fchmod(fd, m_mode); // not restricted by the umask
+
+    if (::ftruncate(fd, sizeof(Segment)) < 0)
+    {
+        SERIALDV_LOG(LogError, "DVSharedServer::start: cannot size %s: %s", m_name.c_str(), strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    void *memory = ::mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (memory == MAP_FAILED)
+    {
+        SERIALDV_LOG(LogError, "DVSharedServer::start: cannot map %s: %s", m_name.c_str(), strerror(errno));
+        return false;
+    }
+
+    // the new segment is zero filled
+    m_segment = static_cast<Segment*>(memory);
+    m_segment->serverPid.store(::getpid());
+    m_segment->version = VERSION;
+    m_segment->nbDevices = controllers.size();
+    std::atomic_thread_fence(std::memory_order_release);
+    m_segment->magic = MAGIC;
+
+    m_controllers = controllers;
+    m_stop = false;
+
+    for (unsigned int device = 0; device < controllers.size(); device++) {
+        m_threads.push_back(std::thread(&DVSharedServer::serve, this, device));
+    }
+
+    SERIALDV_LOG(LogInfo, "DVSharedServer::start: serving %u devices on %s", (unsigned int) controllers.size(), m_name.c_str());
+    return true;
+}
+
+int DVSharedServer::createSegment()
+{
+    int fd = ::shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, m_mode);
+
+    if ((fd >= 0) || (errno != EEXIST))
+    {
+        if (fd < 0) {
+            SERIALDV_LOG(LogError, "DVSharedServer::createSegment: cannot create %s: %s", m_name.c_str(), strerror(errno));
+        }
+
+        return fd;
+    }
+
+    // the segment exists: replace it only if its server is gone
+    fd = ::shm_open(m_name.c_str(), O_RDONLY, 0);
+    struct stat status;
+    pid_t pid = 0;
+
+    if ((fd >= 0) && (::fstat(fd, &status) == 0) && (status.st_size >= (off_t) sizeof(Segment)))
+    {
+        void *memory = ::mmap(nullptr, sizeof(Segment), PROT_READ, MAP_SHARED, fd, 0);
+
+        if (memory != MAP_FAILED)
+        {
+            pid = static_cast<Segment*>(memory)->serverPid.load();
+            ::munmap(memory, sizeof(Segment));
+        }
+    }
+
+    if (fd >= 0) {
+        ::close(fd);
+    }
+
+    if ((pid != 0) && ((::kill(pid, 0) == 0) || (errno == EPERM)))
+    {
+        SERIALDV_LOG(LogError, "DVSharedServer::createSegment: %s is served by process %d", m_name.c_str(), (int) pid);
+        return -1;
+    }
+
+    SERIALDV_LOG(LogInfo, "DVSharedServer::createSegment: replacing %s left by a server that is gone", m_name.c_str());
+    ::shm_unlink(m_name.c_str());
+    fd = ::shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, m_mode);
+
+    if (fd < 0) {
+        SERIALDV_LOG(LogError, "DVSharedServer::createSegment: cannot create %s: %s", m_name.c_str(), strerror(errno));
+    }
+
+    return fd;
+}
+
+void DVSharedServer::stop()
+{
+    if (!m_segment) {
+        return;
+    }
+
+    m_stop = true;
+
+    for (unsigned int device = 0; device < m_threads.size(); device++)
+    {
+        m_segment->deviceFutex[device].fetch_add(1);
+        futexWake(m_segment->deviceFutex[device]);
+    }
+
+    for (unsigned int i = 0; i < m_threads.size(); i++) {
+        m_threads[i].join();
+    }
+
+    m_threads.clear();
+    m_segment->serverPid.store(0);
+    m_segment->magic = 0;
+    ::munmap(m_segment, sizeof(Segment));
+    ::shm_unlink(m_name.c_str());
+    m_segment = nullptr;
+}
+
+unsigned int DVSharedServer::getNbClients() const
+{
+    unsigned int nbClients = 0;
+
+    if (m_segment)
+    {
+        for (unsigned int i = 0; i < NB_SLOTS; i++) {
+            nbClients += m_segment->slots[i].state.load() == SlotAttached ? 1 : 0;
+        }
+    }
+
+    return nbClients;
+}
+
+void DVSharedServer::serve(unsigned int device)
+{
+    DVController& controller = *m_controllers[device];
+    std::atomic<uint32_t>& futex = m_segment->deviceFutex[device];
+    std::atomic<uint32_t>& waiting = m_segment->deviceWaiting[device];
+
+    while (!m_stop)
+    {
+        uint32_t seen = futex.load();
+        bool busy = false;
+
+        for (unsigned int i = 0; i < NB_SLOTS; i++)
+        {
+            Slot& slot = m_segment->slots[i];
+            uint32_t state = slot.state.load(std::memory_order_acquire);
+
+            if ((state == SlotAttached) && (slot.device == device)) {
+                busy = serveSlot(i, controller) || busy;
+            } else if ((state == SlotDetaching) && (slot.device == device)) {
+                slot.state.store(SlotFree); // only this thread serves the slot
+            }
+        }
+
+        if (busy) {
+            continue;
+        }
+
+        // clients bump the futex before checking this flag so that no wake up is lost
+        waiting.store(1);
+
+        if (!futexWait(futex, seen, 100)) {
+            reclaimSlots(device);
+        }
+
+        waiting.store(0);
+    }
+}
+
+bool DVSharedServer::serveSlot(unsigned int slotIndex, DVController& controller)
+{
+    Slot& slot = m_segment->slots[slotIndex];
+    uint32_t tail = slot.requests.tail.load(std::memory_order_relaxed);
+
+    if (tail == slot.requests.head.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    uint32_t responseHead = slot.responses.head.load(std::memory_order_relaxed);
+
+    if (responseHead - slot.responses.tail.load(std::memory_order_acquire) == RING_SIZE) {
+        return false; // client is not collecting
+    }
+
+    // frames are processed in place in the shared memory
+    const Frame& request = slot.requests.frames[tail & (RING_SIZE - 1)];
+    Frame& response = slot.responses.frames[responseHead & (RING_SIZE - 1)];
+    DVRate rate = request.rate < DV_NB_RATES ? (DVRate) request.rate : DVRateNone;
+    bool ok;
+
+    if (request.op == OpEncode) {
+        ok = controller.encode(request.audio, response.mbe, rate, request.gain);
+    } else {
+        ok = controller.decode(response.audio, request.mbe, rate, request.gain);
+    }
+
+    response.sequence = request.sequence;
+    response.op = request.op;
+    response.rate = request.rate;
+    response.gain = request.gain;
+    response.ok = ok ? 1 : 0;
+
+    slot.requests.tail.store(tail + 1, std::memory_order_release);
+    slot.responses.head.store(responseHead + 1, std::memory_order_release);
+    slot.responseFutex.fetch_add(1);
+
+    if (slot.clientWaiting.load()) {
+        futexWake(slot.responseFutex);
+    }
+
+    m_nbFrames++;
+    return true;
+}
+
+void DVSharedServer::reclaimSlots(unsigned int device)
+{
+    for (unsigned int i = 0; i < NB_SLOTS; i++)
+    {
+        Slot& slot = m_segment->slots[i];
+
+        if ((slot.state.load() == SlotAttached) && (slot.device == device)
+         && (::kill(slot.pid.load(), 0) < 0) && (errno == ESRCH))
+        {
+            SERIALDV_LOG(LogInfo, "DVSharedServer::reclaimSlots: client %d is gone", (int) slot.pid.load());
+            slot.state.store(SlotFree);
+        }
+    }
+}
+
+} // namespace SerialDV
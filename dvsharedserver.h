@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DVSHAREDSERVER_H_
+#define DVSHAREDSERVER_H_
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "serialdv_export.h"
+
+namespace SerialDV
+{
+
+class DVController;
+
+namespace SharedMemory
+{
+    struct Segment;
+}
+
+/** Shares the devices opened by this process with other local processes (see DVSharedClient).
+ * Clients exchange frames with the server through lock free rings in a POSIX shared memory
+ * segment and are woken up with futexes so that no system call is made per frame while
+ * the peer is busy. Each client is served by one of the devices, one thread per device.
+ * The segment is created with the given permission mode (default owner and group read/write)
+ * so that clients must run as the same user or group as the server. Linux only.
+ */
+class SERIALDV_API DVSharedServer
+{
+public:
+    explicit DVSharedServer(const std::string& name = "/serialdv", unsigned int mode = 0660);
+    ~DVSharedServer();
+
+    /** Create the shared memory segment and serve the given open controllers (not owned).
+     * Fails if another server is running with the same name. A segment left by a server that
+     * died is replaced.
+     */
+    bool start(const std::vector<DVController*>& controllers);
+    void stop();
+    bool isRunning() const { return m_segment != nullptr; }
+
+    unsigned long long getNbFrames() const { return m_nbFrames.load(); }
+    unsigned int getNbClients() const;
+
+private:
+    std::string m_name;
+    unsigned int m_mode;
+    SharedMemory::Segment *m_segment;
+    std::vector<DVController*> m_controllers;
+    std::vector<std::thread> m_threads;
+    std::atomic<bool> m_stop;
+    std::atomic<unsigned long long> m_nbFrames;
+
+    int createSegment();
+    void serve(unsigned int device);
+    bool serveSlot(unsigned int slotIndex, DVController& controller);
+    void reclaimSlots(unsigned int device);
+};
+
+} // namespace SerialDV
+
+#endif /* DVSHAREDSERVER_H_ */
@@ -27,12 +27,79 @@
 #include <fcntl.h>
 #include <math.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
 #include "dvcontroller.h"
+#include "dvasync.h"
+#include "dvdiscovery.h"
+#include "recordingdatacontroller.h"
+#include "replaydatacontroller.h"
+#ifdef __linux__
+#include "dvsharedserver.h"
+#include "dvsharedclient.h"
+#endif
 
 int exitflag;
 
+typedef std::chrono::steady_clock SoakClock;
+
+struct SoakConfig
+{
+    unsigned int maxStreams;     //!< 0: no soak test
+    unsigned int rampStep;       //!< streams added at each step
+    unsigned int stepSeconds;
+    unsigned int jitterUs;       //!< frames arrive up to this late after their 20 ms slot
+    unsigned int budgetUs;       //!< a frame not encoded and decoded within this misses its deadline
+    float missThreshold;         //!< ramp stops when more than this percentage of frames miss
+};
+
+struct SoakStream;
+
+struct SoakFrame
+{
+    SoakStream *stream;
+    std::atomic<bool> busy;
+    SoakClock::time_point arrival;
+    unsigned char mbe[SerialDV::MBE_FRAME_MAX_LENGTH_BYTES];
+    short audio[SerialDV::MBE_AUDIO_BLOCK_SIZE];
+};
+
+struct SoakStream
+{
+    static const unsigned int NB_SLOTS = 16;  //!< frames of the stream that can be in process
+    const std::vector<short> *source;
+    unsigned int position;                    //!< next sample of the source
+    SoakClock::time_point nominal;            //!< 20 ms slot of the next frame
+    unsigned int nextSlot;
+    SoakFrame frames[NB_SLOTS];
+    double latencySumUs;                      //!< step statistics
+    unsigned int latencyMaxUs;
+    unsigned int nbFrames;
+};
+
+struct SoakStats
+{
+    std::mutex mutex;
+    std::vector<unsigned int> latenciesUs;
+    unsigned int nbMisses;
+    unsigned int nbFailed;
+    unsigned int nbOverruns;                  //!< frames not sent because the stream had too many in process
+    std::atomic<int> nbOutstanding;
+};
+
 static void usage ();
 static void sigfun (int sig);
+static bool loadSoakSource (const char *fileName, std::vector<short>& samples);
+static void soakComplete (SoakFrame *frame, bool ok, unsigned int budgetUs, SoakStats& stats);
+static void soakTest (SerialDV::DVController& controller, const std::vector<std::vector<short> >& sources,
+        SerialDV::DVRate rate, int gain, const SoakConfig& config);
 
 void usage()
 {
@@ -40,6 +107,8 @@ void usage()
     fprintf(stderr, "Usage:\n");
     fprintf(stderr, "  dvtest [options] Encode/decode test loop\n");
     fprintf(stderr, "  dvtest -h        Show help\n");
+    fprintf(stderr, "  dvtest -l        List DV devices found on serial ports (and UDP server given with -D)\n");
+    fprintf(stderr, "  dvtest -S <name> Share the device given with -D with local processes through shared memory <name> (e.g /serialdv)\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "Input/Output options:\n");
     fprintf(stderr, "  -i <device>   Audio input device or file with 8 kS/s S16LE audio samples (default is /dev/audio, - for piped stdin)\n");
@@ -47,6 +116,8 @@ void usage()
     fprintf(stderr, "  -D <device>   Use DVSI AMBE3000 based device for AMBE decoding (e.g. ThumbDV)\n");
     fprintf(stderr, "                Device name is the corresponding TTY USB device e.g /dev/ttyUSB0\n");
     fprintf(stderr, "                Or AMBE server IP and port e.g 172.18.0.2:2345\n");
+    fprintf(stderr, "                Or vocoder server stream socket e.g unix:/run/dv.sock or tcp://host:2345\n");
+    fprintf(stderr, "  -C <name>     Use the device shared by another dvtest -S <name> process instead of -D\n");
     fprintf(stderr, "Decoder options:\n");
     fprintf(stderr, "  -f <num>      Format index\n");
     fprintf(stderr, "     0:         None (does nothing - default)\n");
@@ -64,6 +135,20 @@ void usage()
     fprintf(stderr, "     12:        8000 no FEC\n");
     fprintf(stderr, "     13:        9600 no FEC\n");
     fprintf(stderr, "  -g <num>      linear gain applied to output (decoder - default 1.0)\n");
+    fprintf(stderr, "Debug options:\n");
+    fprintf(stderr, "  -T <file>     Save a trace of device protocol events to file (convert with dvtrace)\n");
+    fprintf(stderr, "  -R <file>     Record the device session to file\n");
+    fprintf(stderr, "  -P <file>     Play back a recorded session in place of the device (with original timing)\n");
+    fprintf(stderr, "  -F            Play back as fast as possible\n");
+    fprintf(stderr, "Soak test options:\n");
+    fprintf(stderr, "  -N <num>      Ramp up to <num> concurrent live streams paced at 50 frames/s to find how many\n");
+    fprintf(stderr, "                the device sustains. Sources are the -i file and the files given after the options\n");
+    fprintf(stderr, "                (e.g. samples/*.raw). Statistics of each step are printed to stdout\n");
+    fprintf(stderr, "  -r <num>      Streams added at each step (default 1)\n");
+    fprintf(stderr, "  -t <s>        Step duration in seconds (default 10)\n");
+    fprintf(stderr, "  -j <ms>       Frame arrival jitter (default 2)\n");
+    fprintf(stderr, "  -b <ms>       Latency budget of the encode and decode of a frame (default 40)\n");
+    fprintf(stderr, "  -m <percent>  Stop when more frames miss their deadline (default 1)\n");
     fprintf(stderr, "\n");
 }
 
@@ -73,6 +158,233 @@ void sigfun(int sig __attribute__((unused)))
     signal(SIGINT, SIG_DFL);
 }
 
+bool loadSoakSource(const char *fileName, std::vector<short>& samples)
+{
+    int fd = open(fileName, O_RDONLY);
+
+    if (fd < 0) {
+        return false;
+    }
+
+    short buffer[SerialDV::MBE_AUDIO_BLOCK_SIZE];
+
+    while (read(fd, (void *) buffer, SerialDV::MBE_AUDIO_BLOCK_BYTES) == SerialDV::MBE_AUDIO_BLOCK_BYTES) {
+        samples.insert(samples.end(), buffer, buffer + SerialDV::MBE_AUDIO_BLOCK_SIZE);
+    }
+
+    close(fd);
+    return !samples.empty();
+}
+
+void soakComplete(SoakFrame *frame, bool ok, unsigned int budgetUs, SoakStats& stats)
+{
+    unsigned int latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(SoakClock::now() - frame->arrival).count();
+    SoakStream *stream = frame->stream;
+
+    {
+        std::lock_guard<std::mutex> lock(stats.mutex);
+
+        if (ok)
+        {
+            stats.latenciesUs.push_back(latencyUs);
+            stats.nbMisses += latencyUs > budgetUs ? 1 : 0;
+            stream->latencySumUs += latencyUs;
+            stream->latencyMaxUs = std::max(stream->latencyMaxUs, latencyUs);
+            stream->nbFrames++;
+        }
+        else
+        {
+            stats.nbMisses++;
+            stats.nbFailed++;
+        }
+    }
+
+    frame->busy = false;
+    stats.nbOutstanding--;
+}
+
+void soakTest(SerialDV::DVController& controller, const std::vector<std::vector<short> >& sources,
+        SerialDV::DVRate rate, int gain, const SoakConfig& config)
+{
+    typedef std::pair<SoakClock::time_point, unsigned int> Arrival;
+    std::priority_queue<Arrival, std::vector<Arrival>, std::greater<Arrival> > arrivals;
+    std::vector<SoakStream*> streams;
+    SoakStats stats;
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> jitter(0, config.jitterUs);
+    std::uniform_int_distribution<int> phase(0, 19999);
+    SerialDV::DVAsync async(controller);
+    unsigned int sustained = 0;
+    unsigned long long queueDelayUs = 0;
+    unsigned long long nbSubmitted = 0;
+
+    stats.nbMisses = 0;
+    stats.nbFailed = 0;
+    stats.nbOverruns = 0;
+    stats.nbOutstanding = 0;
+    async.start();
+
+    fprintf(stdout, "streams   frames  missed%%  overruns  queue_ms  p50_ms  p99_ms  max_ms  stream_mean_ms  stream_max_ms\n");
+    SoakClock::time_point stepEnd = SoakClock::now();
+
+    while (exitflag == 0)
+    {
+        SoakClock::time_point now = SoakClock::now();
+
+        if (now >= stepEnd)
+        {
+            if (!streams.empty())
+            {
+                std::vector<unsigned int> latenciesUs;
+                unsigned int nbMisses, nbOverruns, nbFailed;
+                double streamMeanMinUs = 1e9, streamMeanMaxUs = 0;
+                unsigned int streamMaxUs = 0;
+
+                {
+                    std::lock_guard<std::mutex> lock(stats.mutex);
+                    latenciesUs.swap(stats.latenciesUs);
+                    nbMisses = stats.nbMisses + stats.nbOverruns;
+                    nbOverruns = stats.nbOverruns;
+                    nbFailed = stats.nbFailed;
+                    stats.nbMisses = 0;
+                    stats.nbOverruns = 0;
+                    stats.nbFailed = 0;
+
+                    for (unsigned int i = 0; i < streams.size(); i++)
+                    {
+                        if (streams[i]->nbFrames != 0)
+                        {
+                            double meanUs = streams[i]->latencySumUs / streams[i]->nbFrames;
+                            streamMeanMinUs = std::min(streamMeanMinUs, meanUs);
+                            streamMeanMaxUs = std::max(streamMeanMaxUs, meanUs);
+                        }
+
+                        streamMaxUs = std::max(streamMaxUs, streams[i]->latencyMaxUs);
+                        streams[i]->latencySumUs = 0;
+                        streams[i]->latencyMaxUs = 0;
+                        streams[i]->nbFrames = 0;
+                    }
+                }
+
+                unsigned int nbFrames = latenciesUs.size() + nbFailed + nbOverruns;
+                std::sort(latenciesUs.begin(), latenciesUs.end());
+                unsigned int p50 = latenciesUs.empty() ? 0 : latenciesUs[latenciesUs.size() / 2];
+                unsigned int p99 = latenciesUs.empty() ? 0 : latenciesUs[(latenciesUs.size() * 99) / 100];
+                unsigned int max = latenciesUs.empty() ? 0 : latenciesUs.back();
+                float missed = nbFrames == 0 ? 100.0f : (nbMisses * 100.0f) / nbFrames;
+                unsigned long long submitted = async.getNbSubmitted() - nbSubmitted;
+                double queueMs = submitted == 0 ? 0 : (async.getQueueDelayUs() - queueDelayUs) / (submitted * 1000.0);
+                nbSubmitted += submitted;
+                queueDelayUs = async.getQueueDelayUs();
+
+                fprintf(stdout, "%7u %8u %8.2f %9u %9.2f %7.2f %7.2f %7.2f %7.2f-%-7.2f %13.2f\n",
+                    (unsigned int) streams.size(), nbFrames, missed, nbOverruns, queueMs,
+                    p50 / 1000.0, p99 / 1000.0, max / 1000.0,
+                    streamMeanMaxUs == 0 ? 0 : streamMeanMinUs / 1000.0, streamMeanMaxUs / 1000.0, streamMaxUs / 1000.0);
+                fflush(stdout);
+
+                if (missed > config.missThreshold) {
+                    break;
+                }
+
+                sustained = streams.size();
+            }
+
+            if (streams.size() >= config.maxStreams) {
+                break;
+            }
+
+            // new streams start at a random phase of the 20 ms frame period
+            for (unsigned int i = 0; (i < config.rampStep) && (streams.size() < config.maxStreams); i++)
+            {
+                SoakStream *stream = new SoakStream();
+                stream->source = &sources[streams.size() % sources.size()];
+                stream->position = ((streams.size() * 25) * SerialDV::MBE_AUDIO_BLOCK_SIZE) % stream->source->size();
+                stream->nominal = now + std::chrono::microseconds(phase(random));
+                stream->nextSlot = 0;
+                stream->latencySumUs = 0;
+                stream->latencyMaxUs = 0;
+                stream->nbFrames = 0;
+
+                for (unsigned int j = 0; j < SoakStream::NB_SLOTS; j++)
+                {
+                    stream->frames[j].stream = stream;
+                    stream->frames[j].busy = false;
+                }
+
+                arrivals.push(Arrival(stream->nominal + std::chrono::microseconds(jitter(random)), streams.size()));
+                streams.push_back(stream);
+            }
+
+            stepEnd = now + std::chrono::seconds(config.stepSeconds);
+        }
+
+        Arrival arrival = arrivals.top();
+        arrivals.pop();
+        std::this_thread::sleep_until(std::min(arrival.first, stepEnd));
+
+        if (arrival.first > stepEnd)
+        {
+            arrivals.push(arrival);
+            continue;
+        }
+
+        SoakStream *stream = streams[arrival.second];
+        SoakFrame *frame = &stream->frames[stream->nextSlot];
+
+        if (frame->busy)
+        {
+            std::lock_guard<std::mutex> lock(stats.mutex);
+            stats.nbOverruns++;
+        }
+        else
+        {
+            frame->busy = true;
+            frame->arrival = arrival.first; // latency includes the lateness of this thread
+            stats.nbOutstanding++;
+            unsigned int budgetUs = config.budgetUs;
+            SerialDV::DVAsync *pAsync = &async;
+            SoakStats *pStats = &stats;
+
+            async.encode(&(*stream->source)[stream->position], frame->mbe, rate, 0,
+                [frame, rate, gain, budgetUs, pAsync, pStats](bool ok)
+                {
+                    if (ok)
+                    {
+                        pAsync->decode(frame->audio, frame->mbe, rate, gain,
+                            [frame, budgetUs, pStats](bool ok) { soakComplete(frame, ok, budgetUs, *pStats); });
+                    }
+                    else
+                    {
+                        soakComplete(frame, false, budgetUs, *pStats);
+                    }
+                });
+
+            stream->nextSlot = (stream->nextSlot + 1) % SoakStream::NB_SLOTS;
+        }
+
+        stream->position = (stream->position + SerialDV::MBE_AUDIO_BLOCK_SIZE) % stream->source->size();
+        stream->nominal += std::chrono::milliseconds(20);
+        arrivals.push(Arrival(stream->nominal + std::chrono::microseconds(jitter(random)), arrival.second));
+    }
+
+    // let frames in process complete before their buffers go away
+    SoakClock::time_point drainEnd = SoakClock::now() + std::chrono::seconds(2);
+
+    while ((stats.nbOutstanding > 0) && (SoakClock::now() < drainEnd)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    async.stop();
+
+    for (unsigned int i = 0; i < streams.size(); i++) {
+        delete streams[i];
+    }
+
+    fprintf(stderr, "Sustained %u streams with less than %.2f%% of frames missing a %.1f ms budget\n",
+        sustained, config.missThreshold, config.budgetUs / 1000.0);
+}
+
 int main(int argc, char **argv)
 {
     int c;
@@ -87,15 +399,32 @@ int main(int argc, char **argv)
     std::string dvSerialDevice;
     SerialDV::DVRate dvRate = SerialDV::DVRateNone;
     float  gainLin = 1.0f;
+    bool listDevices = false;
+    std::string traceFile;
+    std::string recordFile;
+    std::string replayFile;
+    bool replayFast = false;
+    std::string sharedServerName;
+    std::string sharedClientName;
+    SoakConfig soakConfig;
+    soakConfig.maxStreams = 0;
+    soakConfig.rampStep = 1;
+    soakConfig.stepSeconds = 10;
+    soakConfig.jitterUs = 2000;
+    soakConfig.budgetUs = 40000;
+    soakConfig.missThreshold = 1.0f;
+    in_file[0] = '\0';
 
     // Catch Ctrl-C and SIGTERM
     struct sigaction sigact;
     sigact.sa_handler = sigfun;
     sigemptyset(&sigact.sa_mask);
     sigact.sa_flags = SA_RESETHAND;
+    sigaction(SIGINT, &sigact, nullptr);
+    sigaction(SIGTERM, &sigact, nullptr);
 
     while ((c = getopt(argc, argv,
-            "hi:o:f:D:g:")) != -1)
+            "hli:o:f:D:g:T:R:P:FS:C:N:r:t:j:b:m:")) != -1)
     {
         opterr = 0;
         switch (c)
@@ -103,6 +432,9 @@ int main(int argc, char **argv)
         case 'h':
             usage();
             exit(0);
+        case 'l':
+            listDevices = true;
+            break;
         case 'i':
             strncpy(in_file, (const char *) optarg, 1023);
             in_file[1023] = '\0';
@@ -129,12 +461,152 @@ int main(int argc, char **argv)
                 gainLin = 0.0f;
             }
             break;
+        case 'T':
+            traceFile = std::string(optarg);
+            break;
+        case 'R':
+            recordFile = std::string(optarg);
+            break;
+        case 'P':
+            replayFile = std::string(optarg);
+            break;
+        case 'F':
+            replayFast = true;
+            break;
+        case 'S':
+            sharedServerName = std::string(optarg);
+            break;
+        case 'C':
+            sharedClientName = std::string(optarg);
+            break;
+        case 'N':
+            sscanf(optarg, "%u", &soakConfig.maxStreams);
+            break;
+        case 'r':
+            sscanf(optarg, "%u", &soakConfig.rampStep);
+            soakConfig.rampStep = soakConfig.rampStep < 1 ? 1 : soakConfig.rampStep;
+            break;
+        case 't':
+            sscanf(optarg, "%u", &soakConfig.stepSeconds);
+            soakConfig.stepSeconds = soakConfig.stepSeconds < 1 ? 1 : soakConfig.stepSeconds;
+            break;
+        case 'j':
+            float jitterMs;
+            sscanf(optarg, "%f", &jitterMs);
+            soakConfig.jitterUs = jitterMs < 0 ? 0 : jitterMs > 19 ? 19000 : (unsigned int) (jitterMs * 1000.0f);
+            break;
+        case 'b':
+            float budgetMs;
+            sscanf(optarg, "%f", &budgetMs);
+            soakConfig.budgetUs = budgetMs < 1 ? 1000 : (unsigned int) (budgetMs * 1000.0f);
+            break;
+        case 'm':
+            sscanf(optarg, "%f", &soakConfig.missThreshold);
+            break;
         default:
             usage();
             exit(0);
         }
     }
 
+    if (listDevices)
+    {
+        std::vector<std::string> udpServers;
+
+        if (dvSerialDevice.find(':') != std::string::npos) {
+            udpServers.push_back(dvSerialDevice);
+        }
+
+        std::vector<SerialDV::DVDeviceInfo> devices = SerialDV::DVDiscovery::discover(udpServers);
+
+        for (unsigned int i = 0; i < devices.size(); i++) {
+            fprintf(stdout, "%s %s\n", devices[i].device.c_str(), devices[i].productId.c_str());
+        }
+
+        return 0;
+    }
+
+#ifdef __linux__
+    if (!sharedServerName.empty())
+    {
+        SerialDV::DVController sharedController;
+        SerialDV::DVSharedServer server(sharedServerName);
+
+        if (!sharedController.open(dvSerialDevice))
+        {
+            fprintf(stderr, "Failed to open DV serial device at %s. Aborting\n", dvSerialDevice.c_str());
+            return 0;
+        }
+
+        if (!server.start(std::vector<SerialDV::DVController*>(1, &sharedController)))
+        {
+            fprintf(stderr, "Failed to share DV serial device at %s. Aborting\n", dvSerialDevice.c_str());
+            return 0;
+        }
+
+        fprintf(stderr, "Sharing %s on %s. Ctrl-C to stop\n", dvSerialDevice.c_str(), sharedServerName.c_str());
+
+        while (exitflag == 0) {
+            sleep(1);
+        }
+
+        server.stop();
+        fprintf(stderr, "Processed %llu frames\n", server.getNbFrames());
+        return 0;
+    }
+#endif
+
+    if (soakConfig.maxStreams != 0)
+    {
+        std::vector<std::vector<short> > sources;
+        std::vector<const char*> fileNames;
+
+        if (in_file[0] != '\0') {
+            fileNames.push_back(in_file);
+        }
+
+        for (int i = optind; i < argc; i++) {
+            fileNames.push_back(argv[i]);
+        }
+
+        for (unsigned int i = 0; i < fileNames.size(); i++)
+        {
+            sources.push_back(std::vector<short>());
+
+            if (!loadSoakSource(fileNames[i], sources.back()))
+            {
+                fprintf(stderr, "Cannot read audio frames from %s. Skipping\n", fileNames[i]);
+                sources.pop_back();
+            }
+        }
+
+        if (sources.empty())
+        {
+            fprintf(stderr, "No audio source for the soak test. Aborting\n");
+            return 0;
+        }
+
+        if (SerialDV::DVController::getNbMbeBytes(dvRate) == 0)
+        {
+            fprintf(stderr, "Soak test needs a format (-f). Aborting\n");
+            return 0;
+        }
+
+        SerialDV::DVController soakController;
+
+        if (!soakController.open(dvSerialDevice))
+        {
+            fprintf(stderr, "Failed to open DV serial device at %s. Aborting\n", dvSerialDevice.c_str());
+            return 0;
+        }
+
+        fprintf(stderr, "Soak test of %s with up to %u streams from %u sources. Ctrl-C to stop\n",
+            dvSerialDevice.c_str(), soakConfig.maxStreams, (unsigned int) sources.size());
+        soakTest(soakController, sources, dvRate, (int) (log10f(gainLin)*10.0f), soakConfig);
+        soakController.close();
+        return 0;
+    }
+
     if (strncmp(in_file, (const char *) "-", 1) == 0)
     {
         in_file_fd = STDIN_FILENO;
@@ -174,10 +646,58 @@ int main(int argc, char **argv)
     }
 
     SerialDV::DVController dvController;
+#ifdef __linux__
+    SerialDV::DVSharedClient sharedClient;
+#endif
     short dvAudioSamples[SerialDV::MBE_AUDIO_BLOCK_SIZE];
     unsigned char dvMbeSamples[SerialDV::MBE_FRAME_MAX_LENGTH_BYTES];
 
-    if (!dvSerialDevice.empty())
+    if (!traceFile.empty()) {
+        dvController.setTrace(65536);
+    }
+
+#ifdef __linux__
+    if (!sharedClientName.empty())
+    {
+        if (sharedClient.attach(sharedClientName))
+        {
+            fprintf(stderr, "Using the device shared on %s\n", sharedClientName.c_str());
+        }
+        else
+        {
+            fprintf(stderr, "Failed to attach to %s. Aborting\n", sharedClientName.c_str());
+            return 0;
+        }
+    }
+    else
+#endif
+    if (!replayFile.empty())
+    {
+        if (dvController.open(new SerialDV::ReplayDataController(!replayFast), replayFile))
+        {
+            fprintf(stderr, "Playing back session from %s\n", replayFile.c_str());
+        }
+        else
+        {
+            fprintf(stderr, "Failed to play back session from %s. Aborting\n", replayFile.c_str());
+            return 0;
+        }
+    }
+    else if (!dvSerialDevice.empty() && !recordFile.empty())
+    {
+        SerialDV::DataController *transport = SerialDV::DVController::createDataController(dvSerialDevice);
+
+        if (dvController.open(new SerialDV::RecordingDataController(transport, recordFile), dvSerialDevice))
+        {
+            fprintf(stderr, "Opened DV serial device at %s recording to %s\n", dvSerialDevice.c_str(), recordFile.c_str());
+        }
+        else
+        {
+            fprintf(stderr, "Failed to open DV serial device at %s. Aborting\n", dvSerialDevice.c_str());
+            return 0;
+        }
+    }
+    else if (!dvSerialDevice.empty())
     {
         if (dvController.open(dvSerialDevice))
         {
@@ -217,13 +737,29 @@ int main(int argc, char **argv)
             break;
         }
 
-        if (!dvController.encode(dvAudioSamples, dvMbeSamples, dvRate))
+#ifdef __linux__
+        bool encoded = sharedClient.isAttached()
+            ? sharedClient.encode(dvAudioSamples, dvMbeSamples, dvRate)
+            : dvController.encode(dvAudioSamples, dvMbeSamples, dvRate);
+#else
+        bool encoded = dvController.encode(dvAudioSamples, dvMbeSamples, dvRate);
+#endif
+
+        if (!encoded)
         {
             fprintf(stderr, "Encoding failure. Terminating\n");
             break;
         }
 
-        if (!dvController.decode(dvAudioSamples, dvMbeSamples, dvRate, gain))
+#ifdef __linux__
+        bool decoded = sharedClient.isAttached()
+            ? sharedClient.decode(dvAudioSamples, dvMbeSamples, dvRate, gain)
+            : dvController.decode(dvAudioSamples, dvMbeSamples, dvRate, gain);
+#else
+        bool decoded = dvController.decode(dvAudioSamples, dvMbeSamples, dvRate, gain);
+#endif
+
+        if (!decoded)
         {
             fprintf(stderr, "Decoding failure. Terminating\n");
             break;
@@ -250,6 +786,15 @@ int main(int argc, char **argv)
     uint64_t ms = tvdiff.tv_sec*1000000 + tvdiff.tv_usec;
     fprintf(stderr, "Done in %f seconds\n", ms / 1e6);
 
+    if (!traceFile.empty())
+    {
+        if (dvController.getTrace()->save(traceFile)) {
+            fprintf(stderr, "Trace saved to %s\n", traceFile.c_str());
+        } else {
+            fprintf(stderr, "Cannot save trace to %s\n", traceFile.c_str());
+        }
+    }
+
     dvController.close();
 
     if ((out_file_fd > -1) && (out_file_fd != STDOUT_FILENO)) {
@@ -0,0 +1,48 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "tracering.h"
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "Usage:\n");
+        fprintf(stderr, "  dvtrace <trace file> <json file>   Convert a binary trace to Chrome trace JSON\n");
+        return 1;
+    }
+
+    std::vector<SerialDV::TraceEvent> events;
+
+    if (!SerialDV::TraceRing::load(argv[1], events))
+    {
+        fprintf(stderr, "Cannot read trace from %s\n", argv[1]);
+        return 1;
+    }
+
+    if (!SerialDV::TraceRing::toChromeJson(events, argv[2]))
+    {
+        fprintf(stderr, "Cannot write %s\n", argv[2]);
+        return 1;
+    }
+
+    fprintf(stderr, "%u events written to %s\n", (unsigned int) events.size(), argv[2]);
+    return 0;
+}
@@ -0,0 +1,234 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <cassert>
+
+#include "framescheduler.h"
+
+namespace SerialDV
+{
+
+FrameScheduler::FrameScheduler(DVController& controller, FrameCallback callback) :
+        m_controller(controller),
+        m_callback(callback),
+        m_nextStreamId(0),
+        m_frameTimeUs(10000.0),
+        m_switchTimeUs(10000.0),
+        m_nbFrames(0),
+        m_nbRateSwitches(0),
+        m_nbDeadlineMisses(0)
+{
+}
+
+FrameScheduler::~FrameScheduler()
+{
+}
+
+int FrameScheduler::addStream(unsigned int latencyBudgetUs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int streamId = m_nextStreamId++;
+    m_streams[streamId].latencyBudgetUs = latencyBudgetUs;
+    return streamId;
+}
+
+void FrameScheduler::removeStream(int streamId)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_streams.erase(streamId);
+}
+
+bool FrameScheduler::queueEncode(int streamId, const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain, void *userData)
+{
+    assert(audioFrame != 0);
+    assert(mbeFrame != 0);
+    Frame frame;
+    frame.encode = true;
+    frame.rate = rate;
+    frame.gain = gain;
+    ::memcpy(frame.audioIn, audioFrame, MBE_AUDIO_BLOCK_BYTES);
+    frame.mbeOut = mbeFrame;
+    frame.audioOut = nullptr;
+    frame.userData = userData;
+    return queueFrame(streamId, frame);
+}
+
+bool FrameScheduler::queueDecode(int streamId, const unsigned char *mbeFrame, short *audioFrame, DVRate rate, int gain, void *userData)
+{
+    assert(audioFrame != 0);
+    assert(mbeFrame != 0);
+    unsigned short nbBytes = DVController::getNbMbeBytes(rate);
+
+    if ((nbBytes == 0) || (nbBytes > MBE_FRAME_MAX_LENGTH_BYTES_INTERNAL)) {
+        return false;
+    }
+
+    Frame frame;
+    frame.encode = false;
+    frame.rate = rate;
+    frame.gain = gain;
+    ::memcpy(frame.mbeIn, mbeFrame, nbBytes);
+    frame.mbeOut = nullptr;
+    frame.audioOut = audioFrame;
+    frame.userData = userData;
+    return queueFrame(streamId, frame);
+}
+
+bool FrameScheduler::queueFrame(int streamId, Frame& frame)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<int, Stream>::iterator it = m_streams.find(streamId);
+
+    if (it == m_streams.end()) {
+        return false;
+    }
+
+    frame.deadline = Clock::now() + std::chrono::microseconds(it->second.latencyBudgetUs);
+    it->second.frames.push_back(frame);
+    return true;
+}
+
+unsigned int FrameScheduler::getNbQueued()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    unsigned int nbQueued = 0;
+
+    for (std::map<int, Stream>::const_iterator it = m_streams.begin(); it != m_streams.end(); ++it) {
+        nbQueued += it->second.frames.size();
+    }
+
+    return nbQueued;
+}
+
+unsigned long long FrameScheduler::getNbFrames()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nbFrames;
+}
+
+unsigned long long FrameScheduler::getNbRateSwitches()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nbRateSwitches;
+}
+
+unsigned long long FrameScheduler::getNbDeadlineMisses()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nbDeadlineMisses;
+}
+
+bool FrameScheduler::selectFrame(int& streamId, Frame& frame)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    DVRate currentRate = m_controller.getCurrentRate();
+    std::map<int, Stream>::iterator earliest = m_streams.end();   // earliest deadline of all
+    std::map<int, Stream>::iterator earliestAtRate = m_streams.end(); // earliest deadline at current rate
+
+    for (std::map<int, Stream>::iterator it = m_streams.begin(); it != m_streams.end(); ++it)
+    {
+        if (it->second.frames.empty()) {
+            continue;
+        }
+
+        const Frame& head = it->second.frames.front();
+
+        if ((earliest == m_streams.end()) || (head.deadline < earliest->second.frames.front().deadline)) {
+            earliest = it;
+        }
+
+        if ((head.rate == currentRate)
+         && ((earliestAtRate == m_streams.end()) || (head.deadline < earliestAtRate->second.frames.front().deadline))) {
+            earliestAtRate = it;
+        }
+    }
+
+    if (earliest == m_streams.end()) {
+        return false;
+    }
+
+    std::map<int, Stream>::iterator selected = earliest;
+
+    if ((earliestAtRate != m_streams.end()) && (earliestAtRate != earliest))
+    {
+        // stay at the current rate unless the earliest frame cannot afford it
+        Clock::time_point latestStart = earliest->second.frames.front().deadline
+            - std::chrono::microseconds((long long) (2*m_frameTimeUs + m_switchTimeUs));
+
+        if (Clock::now() < latestStart) {
+            selected = earliestAtRate;
+        }
+    }
+
+    streamId = selected->first;
+    frame = selected->second.frames.front();
+    selected->second.frames.pop_front();
+    return true;
+}
+
+unsigned int FrameScheduler::process()
+{
+    unsigned int nbProcessed = 0;
+    int streamId;
+    Frame frame;
+
+    while (selectFrame(streamId, frame))
+    {
+        bool rateSwitch = frame.rate != m_controller.getCurrentRate();
+        Clock::time_point start = Clock::now();
+        bool ok;
+
+        if (frame.encode) {
+            ok = m_controller.encode(frame.audioIn, frame.mbeOut, frame.rate, frame.gain);
+        } else {
+            ok = m_controller.decode(frame.audioOut, frame.mbeIn, frame.rate, frame.gain);
+        }
+
+        Clock::time_point end = Clock::now();
+        double elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (rateSwitch)
+            {
+                m_nbRateSwitches++;
+                m_switchTimeUs = 0.9*m_switchTimeUs + 0.1*(elapsedUs - m_frameTimeUs > 0 ? elapsedUs - m_frameTimeUs : 0);
+            }
+            else
+            {
+                m_frameTimeUs = 0.9*m_frameTimeUs + 0.1*elapsedUs;
+            }
+
+            if (end > frame.deadline) {
+                m_nbDeadlineMisses++;
+            }
+
+            m_nbFrames++;
+        }
+
+        nbProcessed++;
+
+        if (m_callback) {
+            m_callback(streamId, ok, frame.userData);
+        }
+    }
+
+    return nbProcessed;
+}
+
+} // namespace SerialDV
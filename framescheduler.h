@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FRAMESCHEDULER_H_
+#define FRAMESCHEDULER_H_
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#include "serialdv_export.h"
+#include "dvcontroller.h"
+
+namespace SerialDV
+{
+
+/** Queues encode and decode frames of several logical streams sharing one DVController
+ * and processes them so that rate switches (RATEP round trips) are minimized.
+ *
+ * Frames of a stream are always processed in order. Among the streams the scheduler keeps
+ * serving frames at the current device rate and switches rate only when there is none left
+ * or when the frame with the earliest deadline would otherwise miss its stream latency budget.
+ *
+ * Queueing functions can be called from any thread. process() must be called from the
+ * thread controlling the device.
+ */
+class SERIALDV_API FrameScheduler
+{
+public:
+    /** Called when a frame has been processed. ok is the result of encode() or decode()
+     */
+    typedef std::function<void(int streamId, bool ok, void *userData)> FrameCallback;
+
+    FrameScheduler(DVController& controller, FrameCallback callback);
+    ~FrameScheduler();
+
+    /** Add a logical stream with a latency budget in microseconds. Returns the stream id
+     */
+    int addStream(unsigned int latencyBudgetUs);
+    void removeStream(int streamId);
+
+    /** Queue one audio frame (MBE_AUDIO_BLOCK_SIZE samples) to encode. Audio is copied.
+     * mbeFrame must stay valid until the callback is called for this frame.
+     */
+    bool queueEncode(int streamId, const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain = 0, void *userData = nullptr);
+
+    /** Queue one AMBE frame to decode. AMBE bytes are copied.
+     * audioFrame must stay valid until the callback is called for this frame.
+     */
+    bool queueDecode(int streamId, const unsigned char *mbeFrame, short *audioFrame, DVRate rate, int gain = 0, void *userData = nullptr);
+
+    /** Process all queued frames. Returns the number of frames processed
+     */
+    unsigned int process();
+
+    unsigned int getNbQueued();
+    unsigned long long getNbFrames();
+    unsigned long long getNbRateSwitches();
+    unsigned long long getNbDeadlineMisses();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Frame
+    {
+        bool encode;
+        DVRate rate;
+        int gain;
+        short audioIn[MBE_AUDIO_BLOCK_SIZE];
+        unsigned char mbeIn[MBE_FRAME_MAX_LENGTH_BYTES_INTERNAL];
+        unsigned char *mbeOut;
+        short *audioOut;
+        Clock::time_point deadline;
+        void *userData;
+    };
+
+    struct Stream
+    {
+        unsigned int latencyBudgetUs;
+        std::deque<Frame> frames;
+    };
+
+    DVController& m_controller;
+    FrameCallback m_callback;
+    std::mutex m_mutex;
+    std::map<int, Stream> m_streams;
+    int m_nextStreamId;
+    double m_frameTimeUs;          //!< moving average of frame processing time
+    double m_switchTimeUs;         //!< moving average of rate switch extra time
+    unsigned long long m_nbFrames;
+    unsigned long long m_nbRateSwitches;
+    unsigned long long m_nbDeadlineMisses;
+
+    bool queueFrame(int streamId, Frame& frame);
+    bool selectFrame(int& streamId, Frame& frame);
+};
+
+} // namespace SerialDV
+
+#endif /* FRAMESCHEDULER_H_ */
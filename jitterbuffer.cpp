@@ -0,0 +1,293 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "jitterbuffer.h"
+
+namespace SerialDV
+{
+
+const unsigned int JitterBuffer::FRAME_TIME_US;
+const unsigned int JitterBuffer::CAPACITY;
+
+JitterBuffer::JitterBuffer(DVController& controller, DVRate rate, int gain, unsigned int minDelayUs, unsigned int maxDelayUs) :
+        m_controller(controller),
+        m_rate(rate),
+        m_gain(gain),
+        m_nbMbeBytes(DVController::getNbMbeBytes(rate)),
+        m_minDelayUs(minDelayUs),
+        m_maxDelayUs(maxDelayUs < minDelayUs ? minDelayUs : maxDelayUs),
+        m_stop(false),
+        m_anchored(false),
+        m_lastSequence(0),
+        m_lastExtended(0),
+        m_nextPlay(0),
+        m_lastTransitUs(0.0),
+        m_jitterUs(0.0),
+        m_spikeUs(0.0),
+        m_delayUs(minDelayUs),
+        m_decodeTimeUs(5000.0),
+        m_nbMissing(0),
+        m_nbReceived(0),
+        m_nbPlayed(0),
+        m_nbLate(0),
+        m_nbLost(0),
+        m_nbDropped(0)
+{
+    assert(m_nbMbeBytes <= MBE_FRAME_MAX_LENGTH_BYTES_INTERNAL);
+
+    for (unsigned int i = 0; i < CAPACITY; i++) {
+        m_slots[i].sequence = -1;
+    }
+}
+
+JitterBuffer::~JitterBuffer()
+{
+    stop();
+}
+
+void JitterBuffer::start(PlayoutCallback callback)
+{
+    if (m_thread.joinable()) {
+        return;
+    }
+
+    m_callback = callback;
+    m_stop = false;
+    m_thread = std::thread(&JitterBuffer::run, this);
+}
+
+void JitterBuffer::stop()
+{
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_cond.notify_one();
+    m_thread.join();
+}
+
+bool JitterBuffer::push(uint32_t sequence, const unsigned char *mbeFrame)
+{
+    assert(mbeFrame != 0);
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    long long extended;
+    m_nbReceived++;
+
+    if (m_anchored)
+    {
+        extended = m_lastExtended + (int32_t) (sequence - m_lastSequence);
+
+        if (extended > m_lastExtended)
+        {
+            m_lastSequence = sequence;
+            m_lastExtended = extended;
+        }
+    }
+    else
+    {
+        // new talkspurt: its first frame sets the reference with no transit delay
+        for (unsigned int i = 0; i < CAPACITY; i++) {
+            m_slots[i].sequence = -1;
+        }
+
+        extended = 0;
+        m_lastSequence = sequence;
+        m_lastExtended = 0;
+        m_nextPlay = 0;
+        m_reference = now;
+        m_lastTransitUs = 0.0;
+        m_nbMissing = 0;
+        m_delayUs = targetDelayUs();
+        m_anchored = true;
+        m_cond.notify_one();
+    }
+
+    double transitUs = std::chrono::duration<double, std::micro>(now - m_reference).count() - (double) extended * FRAME_TIME_US;
+    m_jitterUs += (std::fabs(transitUs - m_lastTransitUs) - m_jitterUs) / 16.0;
+    m_lastTransitUs = transitUs;
+
+    if (extended < m_nextPlay)
+    {
+        // the delay this frame would have needed is applied at once
+        double neededUs = transitUs + 2.0*m_decodeTimeUs;
+        m_spikeUs = neededUs > m_spikeUs ? neededUs : m_spikeUs;
+        double targetUs = targetDelayUs();
+        m_delayUs = targetUs > m_delayUs ? targetUs : m_delayUs;
+        m_nbLate++;
+        return false;
+    }
+
+    if (extended >= m_nextPlay + CAPACITY)
+    {
+        m_nbDropped++;
+        return false;
+    }
+
+    Slot& slot = m_slots[extended % CAPACITY];
+
+    if (slot.sequence == extended)
+    {
+        m_nbDropped++;
+        return false;
+    }
+
+    slot.sequence = extended;
+    ::memcpy(slot.mbe, mbeFrame, m_nbMbeBytes);
+    return true;
+}
+
+unsigned int JitterBuffer::getDelayUs()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (unsigned int) m_delayUs;
+}
+
+unsigned int JitterBuffer::getJitterUs()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (unsigned int) m_jitterUs;
+}
+
+unsigned long long JitterBuffer::getNbReceived()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nbReceived;
+}
+
+unsigned long long JitterBuffer::getNbPlayed()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nbPlayed;
+}
+
+unsigned long long JitterBuffer::getNbLate()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nbLate;
+}
+
+unsigned long long JitterBuffer::getNbLost()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nbLost;
+}
+
+unsigned long long JitterBuffer::getNbDropped()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nbDropped;
+}
+
+double JitterBuffer::targetDelayUs() const
+{
+    double targetUs = 4.0*m_jitterUs + 2.0*m_decodeTimeUs;
+    targetUs = m_spikeUs > targetUs ? m_spikeUs : targetUs;
+    return targetUs < m_minDelayUs ? m_minDelayUs : targetUs > m_maxDelayUs ? m_maxDelayUs : targetUs;
+}
+
+JitterBuffer::Clock::time_point JitterBuffer::playoutTime(long long extended) const
+{
+    return m_reference + std::chrono::microseconds((long long) (extended * FRAME_TIME_US + m_delayUs));
+}
+
+void JitterBuffer::run()
+{
+    short audioFrame[MBE_AUDIO_BLOCK_SIZE];
+    unsigned char mbeFrame[MBE_FRAME_MAX_LENGTH_BYTES_INTERNAL];
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (!m_stop)
+    {
+        if (!m_anchored)
+        {
+            m_cond.wait(lock);
+            continue;
+        }
+
+        Clock::time_point decodeTime = playoutTime(m_nextPlay) - std::chrono::microseconds((long long) (2.0*m_decodeTimeUs));
+
+        if (Clock::now() < decodeTime)
+        {
+            m_cond.wait_until(lock, decodeTime);
+            continue;
+        }
+
+        Slot& slot = m_slots[m_nextPlay % CAPACITY];
+        bool present = slot.sequence == m_nextPlay;
+        uint32_t sequence = m_lastSequence - (uint32_t) (m_lastExtended - m_nextPlay);
+
+        if (present)
+        {
+            ::memcpy(mbeFrame, slot.mbe, m_nbMbeBytes);
+            slot.sequence = -1;
+            m_nbLost += m_nbMissing; // frames missing in the middle of a talkspurt
+            m_nbMissing = 0;
+        }
+        else if (++m_nbMissing * FRAME_TIME_US >= m_maxDelayUs)
+        {
+            // end of talkspurt: trailing missing frames are not losses
+            m_anchored = false;
+            m_nbMissing = 0;
+            continue;
+        }
+
+        m_nextPlay++;
+        double targetUs = targetDelayUs();
+        m_delayUs += targetUs > m_delayUs + 1000.0 ? 1000.0 : targetUs < m_delayUs - 1000.0 ? -1000.0 : targetUs - m_delayUs;
+        m_spikeUs *= 0.98;
+        lock.unlock();
+
+        JitterFrameStatus status = JitterFrameLost;
+
+        if (present)
+        {
+            Clock::time_point start = Clock::now();
+
+            if (m_controller.decode(audioFrame, mbeFrame, m_rate, m_gain)) {
+                status = JitterFramePlayed;
+            }
+
+            double elapsedUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            lock.lock();
+            m_decodeTimeUs = 0.9*m_decodeTimeUs + 0.1*elapsedUs;
+            m_nbPlayed += status == JitterFramePlayed ? 1 : 0;
+            m_nbLost += status == JitterFramePlayed ? 0 : 1;
+            lock.unlock();
+        }
+
+        if (status == JitterFrameLost) {
+            ::memset(audioFrame, 0, MBE_AUDIO_BLOCK_BYTES);
+        }
+
+        if (m_callback) {
+            m_callback(sequence, audioFrame, status);
+        }
+
+        lock.lock();
+    }
+}
+
+} // namespace SerialDV
@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef JITTERBUFFER_H_
+#define JITTERBUFFER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+
+#include "serialdv_export.h"
+#include "dvcontroller.h"
+
+namespace SerialDV
+{
+
+enum JitterFrameStatus
+{
+    JitterFramePlayed,    //!< frame received in time and decoded
+    JitterFrameLost       //!< no frame at playout time: audio is silence
+};
+
+/** Adaptive jitter buffer in front of decode() for AMBE frames received from a network.
+ *
+ * Frames are pushed as they arrive with their sequence number (or timestamp divided by
+ * the number of samples per frame). A playout thread decodes each frame just ahead of its
+ * playout deadline, leaving room for the measured decode time, and hands the audio to the
+ * playout callback. Device work is therefore spread at the frame rate whatever the arrival
+ * pattern.
+ *
+ * The playout delay follows the interarrival jitter (RFC 3550 estimator) between a minimum
+ * and a maximum. It is raised at once after a late frame and otherwise moves by at most
+ * 1 ms per frame. After a silence longer than the maximum delay the next talkspurt is
+ * re-anchored on its first frame.
+ *
+ * DVController is not thread safe and the playout thread calls its decode(): the controller
+ * must not be used by anything else between start() and stop().
+ */
+class SERIALDV_API JitterBuffer
+{
+public:
+    typedef std::function<void(uint32_t sequence, const short *audioFrame, JitterFrameStatus status)> PlayoutCallback;
+
+    static const unsigned int FRAME_TIME_US = 20000U;
+    static const unsigned int CAPACITY = 64U;    //!< frames held ahead of the playout point
+
+    JitterBuffer(DVController& controller, DVRate rate, int gain = 0, unsigned int minDelayUs = 20000U, unsigned int maxDelayUs = 200000U);
+    ~JitterBuffer();
+
+    void start(PlayoutCallback callback);
+    void stop();
+
+    /** Queue one received AMBE frame. Can be called from any thread. Returns false when the frame
+     * is dropped: late (its playout time has passed), duplicate or too far ahead.
+     */
+    bool push(uint32_t sequence, const unsigned char *mbeFrame);
+
+    unsigned int getDelayUs();
+    unsigned int getJitterUs();
+    unsigned long long getNbReceived();
+    unsigned long long getNbPlayed();
+    unsigned long long getNbLate();
+    unsigned long long getNbLost();
+    unsigned long long getNbDropped();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Slot
+    {
+        long long sequence;   //!< extended sequence or -1 if empty
+        unsigned char mbe[MBE_FRAME_MAX_LENGTH_BYTES_INTERNAL];
+    };
+
+    DVController& m_controller;
+    DVRate m_rate;
+    int m_gain;
+    unsigned int m_nbMbeBytes;
+    double m_minDelayUs;
+    double m_maxDelayUs;
+    PlayoutCallback m_callback;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_stop;
+    Slot m_slots[CAPACITY];
+    bool m_anchored;              //!< a talkspurt is being played
+    uint32_t m_lastSequence;      //!< last sequence pushed, for wrap around
+    long long m_lastExtended;     //!< its extended value
+    long long m_nextPlay;         //!< extended sequence of the next frame to play
+    Clock::time_point m_reference;   //!< arrival time of the extended sequence 0 at zero transit
+    double m_lastTransitUs;
+    double m_jitterUs;
+    double m_spikeUs;             //!< extra delay after a late frame, decays
+    double m_delayUs;             //!< current playout delay
+    double m_decodeTimeUs;        //!< moving average of decode time
+    unsigned int m_nbMissing;     //!< consecutive lost frames
+    unsigned long long m_nbReceived;
+    unsigned long long m_nbPlayed;
+    unsigned long long m_nbLate;
+    unsigned long long m_nbLost;
+    unsigned long long m_nbDropped;
+
+    void run();
+    double targetDelayUs() const;
+    Clock::time_point playoutTime(long long extended) const;
+};
+
+} // namespace SerialDV
+
+#endif /* JITTERBUFFER_H_ */
@@ -0,0 +1,269 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#include "logger.h"
+
+namespace SerialDV
+{
+
+namespace
+{
+
+void stderrSink(LogLevel level, const char *message, void *userData)
+{
+    (void) level;
+    (void) userData;
+    ::fprintf(stderr, "%s\n", message);
+}
+
+/** Bounded multiple producers single consumer queue of messages (Vyukov's bounded queue)
+ * with the logging thread as consumer.
+ */
+class LogQueue
+{
+public:
+    LogQueue() :
+        m_sink(stderrSink),
+        m_sinkUserData(nullptr),
+        m_level(LogInfo),
+        m_rateLimit(100),
+        m_rateWindow(0),
+        m_rateCount(0),
+        m_nbDropped(0),
+        m_enqueuePos(0),
+        m_dequeuePos(0),
+        m_stop(false)
+    {
+        for (unsigned int i = 0; i < Logger::QUEUE_SIZE; i++) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        m_thread = std::thread(&LogQueue::run, this);
+    }
+
+    ~LogQueue()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+
+        m_cond.notify_one();
+        m_thread.join();
+    }
+
+    void vlog(LogLevel level, const char *format, va_list args)
+    {
+        if (level < m_level.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        // errors are not rate limited so that a burst of lower level messages does not hide them
+        if ((level < LogError) && !takeRateToken())
+        {
+            m_nbDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        unsigned int pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Slot *slot;
+
+        while (true)
+        {
+            slot = &m_slots[pos & (Logger::QUEUE_SIZE - 1)];
+            unsigned int sequence = slot->sequence.load(std::memory_order_acquire);
+            int diff = (int) sequence - (int) pos;
+
+            if (diff == 0)
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) // full
+            {
+                m_nbDropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->level = level;
+        ::vsnprintf(slot->message, Logger::MESSAGE_LENGTH, format, args);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        m_cond.notify_one();
+    }
+
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        unsigned int target = m_enqueuePos.load(std::memory_order_acquire);
+        m_cond.notify_one();
+        m_flushCond.wait_for(lock, std::chrono::seconds(1), [this, target]() {
+            return (int) (m_dequeuePos.load(std::memory_order_acquire) - target) >= 0;
+        });
+    }
+
+    void setSink(LogSink sink, void *userData)
+    {
+        std::lock_guard<std::mutex> lock(m_sinkMutex);
+        m_sink = sink ? sink : stderrSink;
+        m_sinkUserData = userData;
+    }
+
+    LogSink m_sink;
+    void *m_sinkUserData;
+    std::atomic<LogLevel> m_level;
+    std::atomic<unsigned int> m_rateLimit;
+    std::atomic<long long> m_rateWindow;   //!< current one second window
+    std::atomic<unsigned int> m_rateCount; //!< messages in current window
+    std::atomic<unsigned long long> m_nbDropped;
+
+private:
+    struct Slot
+    {
+        std::atomic<unsigned int> sequence;
+        LogLevel level;
+        char message[Logger::MESSAGE_LENGTH];
+    };
+
+    Slot m_slots[Logger::QUEUE_SIZE];
+    std::atomic<unsigned int> m_enqueuePos;
+    std::atomic<unsigned int> m_dequeuePos;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::mutex m_sinkMutex;
+    std::condition_variable m_cond;
+    std::condition_variable m_flushCond;
+    bool m_stop;
+
+    bool takeRateToken()
+    {
+        unsigned int limit = m_rateLimit.load(std::memory_order_relaxed);
+
+        if (limit == 0) {
+            return true;
+        }
+
+        long long window = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        long long current = m_rateWindow.load(std::memory_order_relaxed);
+
+        if ((window != current) && m_rateWindow.compare_exchange_strong(current, window)) {
+            m_rateCount.store(0, std::memory_order_relaxed);
+        }
+
+        return m_rateCount.fetch_add(1, std::memory_order_relaxed) < limit;
+    }
+
+    bool dequeue()
+    {
+        unsigned int pos = m_dequeuePos.load(std::memory_order_relaxed);
+        Slot& slot = m_slots[pos & (Logger::QUEUE_SIZE - 1)];
+
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_sinkMutex);
+            m_sink(slot.level, slot.message, m_sinkUserData);
+        }
+
+        slot.sequence.store(pos + Logger::QUEUE_SIZE, std::memory_order_release);
+        m_dequeuePos.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    void run()
+    {
+        while (true)
+        {
+            while (dequeue()) {}
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_flushCond.notify_all();
+
+            if (m_stop) {
+                break;
+            }
+
+            // producers do not take the mutex so a notification may be missed: poll as a backstop
+            m_cond.wait_for(lock, std::chrono::milliseconds(10));
+        }
+
+        while (dequeue()) {}
+    }
+};
+
+LogQueue& logQueue()
+{
+    static LogQueue queue;
+    return queue;
+}
+
+} // anonymous namespace
+
+void Logger::setSink(LogSink sink, void *userData)
+{
+    logQueue().setSink(sink, userData);
+}
+
+void Logger::setLevel(LogLevel level)
+{
+    logQueue().m_level.store(level);
+}
+
+LogLevel Logger::getLevel()
+{
+    return logQueue().m_level.load();
+}
+
+void Logger::setRateLimit(unsigned int messagesPerSecond)
+{
+    logQueue().m_rateLimit.store(messagesPerSecond);
+}
+
+void Logger::log(LogLevel level, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    logQueue().vlog(level, format, args);
+    va_end(args);
+}
+
+void Logger::flush()
+{
+    logQueue().flush();
+}
+
+unsigned long long Logger::getNbDropped()
+{
+    return logQueue().m_nbDropped.load();
+}
+
+} // namespace SerialDV
@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+#include "serialdv_export.h"
+
+namespace SerialDV
+{
+
+typedef enum
+{
+    LogDebug,
+    LogInfo,
+    LogWarning,
+    LogError,
+    LogNone
+} LogLevel;
+
+/** Receives log messages (without trailing new line) from the logging thread
+ */
+typedef void (*LogSink)(LogLevel level, const char *message, void *userData);
+
+/** Library wide logging. Messages are formatted in the calling thread then passed
+ * through a lock free queue to a logging thread that hands them over to the sink
+ * (stderr by default). Callers never block on the sink. When the queue is full or
+ * the rate limit is reached messages are dropped and counted.
+ */
+class SERIALDV_API Logger
+{
+public:
+    static const unsigned int MESSAGE_LENGTH = 200U;
+    static const unsigned int QUEUE_SIZE = 256U; //!< must be a power of 2
+
+    /** Set the sink. nullptr restores the default stderr sink
+     */
+    static void setSink(LogSink sink, void *userData = nullptr);
+
+    /** Messages below this level are ignored. Default is LogInfo
+     */
+    static void setLevel(LogLevel level);
+    static LogLevel getLevel();
+
+    /** Maximum number of messages per second passed to the sink. 0 is unlimited. Default is 100.
+     * Errors are not counted nor limited.
+     */
+    static void setRateLimit(unsigned int messagesPerSecond);
+
+    static void log(LogLevel level, const char *format, ...)
+#if defined(__GNUC__)
+        __attribute__((format(printf, 2, 3)))
+#endif
+        ;
+
+    /** Wait until all queued messages have been given to the sink
+     */
+    static void flush();
+
+    static unsigned long long getNbDropped();
+};
+
+} // namespace SerialDV
+
+/** Messages below this level are compiled out
+ */
+#ifndef SERIALDV_LOG_LEVEL
+#define SERIALDV_LOG_LEVEL 0
+#endif
+
+#define SERIALDV_LOG(level, ...) \
+    do { if ((int) (level) >= SERIALDV_LOG_LEVEL) ::SerialDV::Logger::log(level, __VA_ARGS__); } while (0)
+
+#endif /* LOGGER_H_ */
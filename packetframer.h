@@ -0,0 +1,208 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PACKETFRAMER_H_
+#define PACKETFRAMER_H_
+
+// Internal header: definition of DataController::readFramedPacket for the stream transports
+
+#include <chrono>
+#include <thread>
+
+#include "datacontroller.h"
+#include "dvcontroller.h"
+#include "logger.h"
+#include "tracering.h"
+
+namespace SerialDV
+{
+
+/** Calls the transport's own read methods directly. Only for an object whose dynamic type is exactly Transport
+ */
+template<class Transport>
+class DirectStream
+{
+public:
+    explicit DirectStream(Transport& transport) : m_transport(transport) {}
+    bool initResponse() { return m_transport.Transport::initResponse(); }
+    int read(unsigned char* buffer, unsigned int lengthInBytes) { return m_transport.Transport::read(buffer, lengthInBytes); }
+
+private:
+    Transport& m_transport;
+};
+
+template<class Stream>
+int DataController::readFramedPacket(Stream& stream, PacketView& packet, unsigned int timeoutUs)
+{
+    unsigned char *buffer = m_packetBuffer;
+    unsigned int polls = timeoutUs / 100; // per part of the packet
+
+    if (!stream.initResponse())
+    {
+        SERIALDV_LOG(LogError, "DataController::readPacket: cannot get response");
+
+        if (m_trace) {
+            m_trace->record(TraceError);
+        }
+
+        return -1;
+    }
+
+    bool found = false;
+    int packetLength, offset;
+
+    for (unsigned int i = 0; i < polls; i++)
+    {
+        int len1 = stream.read(buffer, 1U);
+
+        if (len1 < 0)
+        {
+            SERIALDV_LOG(LogError, "DataController::readPacket: Error (start byte)");
+
+            if (m_trace) {
+                m_trace->record(TraceError);
+            }
+
+            return -1;
+        }
+        else if ((len1 == 1) && (buffer[0U] == DV3000_START_BYTE))
+        {
+            if (m_trace) {
+                m_trace->record(TraceFirstByte);
+            }
+
+            found = true;
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    if (!found)
+    {
+        SERIALDV_LOG(LogWarning, "DataController::readPacket: Timeout (start byte)");
+
+        if (m_trace) {
+            m_trace->record(TraceTimeout, TraceRing::NO_PACKET_TYPE, 0, 0);
+        }
+
+        return 0;
+    }
+
+    packetLength = 3;
+    offset = 0;
+    found = false;
+
+    for (unsigned int i = 0; i < polls; i++)
+    {
+        int len1 = stream.read(&buffer[1 + offset], packetLength - offset);
+
+        if (len1 < 0)
+        {
+            SERIALDV_LOG(LogError, "DataController::readPacket: Error (packet header at %d)", offset);
+
+            if (m_trace) {
+                m_trace->record(TraceError);
+            }
+
+            return -1;
+        }
+        else if (offset + len1 == packetLength)
+        {
+            found = true;
+            break;
+        }
+        else
+        {
+            offset += len1;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    if (!found)
+    {
+        SERIALDV_LOG(LogWarning, "DataController::readPacket: Timeout (packet header)");
+
+        if (m_trace) {
+            m_trace->record(TraceTimeout, TraceRing::NO_PACKET_TYPE, 0, 1);
+        }
+
+        return 0;
+    }
+
+    packetLength = buffer[1] * 256 + buffer[2];
+
+    if (DV3000_HEADER_LEN + (unsigned int) packetLength > BUFFER_LENGTH)
+    {
+        SERIALDV_LOG(LogError, "DataController::readPacket: packet too long (%d)", packetLength);
+        return -1;
+    }
+
+    offset = 0;
+    found = false;
+
+    for (unsigned int i = 0; i < polls; i++)
+    {
+        int len1 = stream.read(&buffer[4 + offset], packetLength - offset);
+
+        if (len1 < 0)
+        {
+            SERIALDV_LOG(LogError, "DataController::readPacket: Error (packet payload at %d)", offset);
+
+            if (m_trace) {
+                m_trace->record(TraceError);
+            }
+
+            return -1;
+        }
+        else if (offset + len1 == packetLength)
+        {
+            found = true;
+            break;
+        }
+        else
+        {
+            offset += len1;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    if (!found)
+    {
+        SERIALDV_LOG(LogWarning, "DataController::readPacket: Timeout (packet payload)");
+
+        if (m_trace) {
+            m_trace->record(TraceTimeout, TraceRing::NO_PACKET_TYPE, 0, 2);
+        }
+
+        return 0;
+    }
+
+    packet.data = buffer;
+    packet.length = DV3000_HEADER_LEN + packetLength;
+
+    if (m_trace) {
+        m_trace->record(TracePacketComplete, buffer[3], packet.length);
+    }
+
+    return packet.length;
+}
+
+} // namespace SerialDV
+
+#endif /* PACKETFRAMER_H_ */
@@ -0,0 +1,180 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <cstdio>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+#include "realtimethread.h"
+
+namespace SerialDV
+{
+
+RealTimeThread::RealTimeThread() :
+        m_job(nullptr),
+        m_jobArg(nullptr),
+        m_jobDone(false),
+        m_started(false),
+        m_stop(false)
+{
+}
+
+RealTimeThread::~RealTimeThread()
+{
+    stop();
+}
+
+RealTimeStatus RealTimeThread::start(const RealTimeConfig& config)
+{
+    stop();
+    m_config = config;
+    m_status = RealTimeStatus();
+    m_started = false;
+    m_stop = false;
+    m_thread = std::thread(&RealTimeThread::threadMain, this);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond.wait(lock, [this]() { return m_started; });
+    return m_status;
+}
+
+void RealTimeThread::stop()
+{
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_cond.notify_all();
+    m_thread.join();
+    m_status.running = false;
+
+#if defined(__linux__)
+    if (m_status.memoryLocked)
+    {
+        ::munlockall(); // also removes locks the application may have set
+        m_status.memoryLocked = false;
+    }
+#endif
+}
+
+void RealTimeThread::run(Job job, void *arg)
+{
+    std::lock_guard<std::mutex> submitLock(m_submitMutex);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_job = job;
+    m_jobArg = arg;
+    m_jobDone = false;
+    m_cond.notify_all();
+    m_cond.wait(lock, [this]() { return m_jobDone; });
+}
+
+void RealTimeThread::threadMain()
+{
+    setup();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_status.running = true;
+    m_started = true;
+    m_cond.notify_all();
+
+    while (true)
+    {
+        m_cond.wait(lock, [this]() { return m_stop || (m_job != nullptr); });
+
+        if (m_stop) {
+            break;
+        }
+
+        Job job = m_job;
+        void *arg = m_jobArg;
+        lock.unlock();
+        job(arg);
+        lock.lock();
+        m_job = nullptr;
+        m_jobDone = true;
+        m_cond.notify_all();
+    }
+}
+
+void RealTimeThread::setup()
+{
+#if defined(__linux__)
+    if (m_config.cpu >= 0)
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(m_config.cpu, &cpuSet);
+        m_status.affinitySet = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+    }
+
+    if (m_config.priority > 0)
+    {
+        struct sched_param param;
+        param.sched_priority = m_config.priority;
+        m_status.prioritySet = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+    }
+
+    if (m_config.lockMemory)
+    {
+        m_status.memoryLocked = ::mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+
+        // touch the stack the I/O functions will use so that it is resident before the first frame
+        volatile unsigned char stackPrefault[64*1024];
+
+        for (unsigned int i = 0; i < sizeof(stackPrefault); i += 1024) {
+            stackPrefault[i] = 0;
+        }
+    }
+#endif
+}
+
+bool RealTimeThread::setLatencyTimer(const std::string& device, int latencyMs)
+{
+#if defined(__linux__)
+    std::string::size_type pos = device.rfind("ttyUSB");
+
+    if (pos == std::string::npos) {
+        return false;
+    }
+
+    std::string path = "/sys/bus/usb-serial/devices/" + device.substr(pos) + "/latency_timer";
+    FILE *file = ::fopen(path.c_str(), "w");
+
+    if (!file) {
+        return false;
+    }
+
+    bool ok = ::fprintf(file, "%d\n", latencyMs) > 0;
+    ok = (::fclose(file) == 0) && ok;
+    return ok;
+#else
+    (void) device;
+    (void) latencyMs;
+    return false;
+#endif
+}
+
+} // namespace SerialDV
@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALTIMETHREAD_H_
+#define REALTIMETHREAD_H_
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "serialdv_export.h"
+
+namespace SerialDV
+{
+
+struct RealTimeConfig
+{
+    int cpu;                //!< CPU the I/O thread is pinned to or -1 to leave affinity unchanged
+    int priority;           //!< SCHED_FIFO priority (1 to 99) or 0 to keep normal scheduling
+    bool lockMemory;        //!< lock all process memory and pre-fault the I/O thread stack. Unlocked on stop
+    bool setLatencyTimer;   //!< set FTDI latency_timer of the serial device to 1 ms
+
+    RealTimeConfig() :
+        cpu(-1),
+        priority(0),
+        lockMemory(false),
+        setLatencyTimer(true)
+    {}
+};
+
+/** What could actually be applied of a RealTimeConfig. Requested settings that are false
+ * here failed, most often for lack of privileges (CAP_SYS_NICE, CAP_IPC_LOCK, root).
+ */
+struct RealTimeStatus
+{
+    bool running;
+    bool affinitySet;
+    bool prioritySet;
+    bool memoryLocked;
+    bool latencyTimerSet;
+
+    RealTimeStatus() :
+        running(false),
+        affinitySet(false),
+        prioritySet(false),
+        memoryLocked(false),
+        latencyTimerSet(false)
+    {}
+};
+
+/** Dedicated thread running jobs submitted by other threads one at a time.
+ * Submitting a job does not allocate memory.
+ */
+class SERIALDV_API RealTimeThread
+{
+public:
+    typedef void (*Job)(void *arg);
+
+    RealTimeThread();
+    ~RealTimeThread();
+
+    /** Start the thread with the given settings. Returns what could be applied
+     */
+    RealTimeStatus start(const RealTimeConfig& config);
+    void stop();
+    bool isRunning() const { return m_status.running; }
+    const RealTimeStatus& getStatus() const { return m_status; }
+
+    /** Run job in the thread and wait for its completion
+     */
+    void run(Job job, void *arg);
+
+    /** Set FTDI latency_timer (in ms) of a /dev/ttyUSBx device. Returns false if not possible
+     */
+    static bool setLatencyTimer(const std::string& device, int latencyMs);
+
+private:
+    std::thread m_thread;
+    std::mutex m_submitMutex;     //!< one submitter at a time
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    Job m_job;
+    void *m_jobArg;
+    bool m_jobDone;
+    bool m_started;
+    bool m_stop;
+    RealTimeConfig m_config;
+    RealTimeStatus m_status;
+
+    void threadMain();
+    void setup();
+};
+
+} // namespace SerialDV
+
+#endif /* REALTIMETHREAD_H_ */
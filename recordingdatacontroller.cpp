@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cstring>
+
+#include "recordingdatacontroller.h"
+#include "logger.h"
+
+namespace SerialDV
+{
+
+static uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+RecordingDataController::RecordingDataController(DataController *transport, const std::string& sessionFileName) :
+    m_transport(transport),
+    m_sessionFileName(sessionFileName),
+    m_file(nullptr),
+    m_startNs(0),
+    m_nbRecords(0)
+{}
+
+RecordingDataController::~RecordingDataController()
+{
+    if (m_file) {
+        ::fclose(m_file);
+    }
+
+    delete m_transport;
+}
+
+bool RecordingDataController::open(const std::string& device, SERIAL_SPEED speed)
+{
+    if (!m_transport->open(device, speed)) {
+        return false;
+    }
+
+    if (m_file) // reopened during recovery: keep on recording in the same session
+    {
+        return true;
+    }
+
+    m_file = ::fopen(m_sessionFileName.c_str(), "wb");
+
+    if (!m_file)
+    {
+        SERIALDV_LOG(LogError, "RecordingDataController::open: cannot create %s", m_sessionFileName.c_str());
+        m_transport->closeIt();
+        return false;
+    }
+
+    SessionFileHeader header;
+    memcpy(header.magic, "SDVSESSN", sizeof(header.magic));
+    header.version = 1;
+    ::fwrite(&header, sizeof(header), 1, m_file);
+    m_startNs = nowNs();
+    m_nbRecords = 0;
+
+    return true;
+}
+
+bool RecordingDataController::initResponse()
+{
+    return m_transport->initResponse();
+}
+
+int RecordingDataController::read(unsigned char* buffer, unsigned int lengthInBytes)
+{
+    int length = m_transport->read(buffer, lengthInBytes);
+
+    if (length != 0) {
+        record(SessionRead, buffer, length);
+    }
+
+    return length;
+}
+
+int RecordingDataController::write(const unsigned char* buffer, unsigned int lengthInBytes)
+{
+    int length = m_transport->write(buffer, lengthInBytes);
+    record(SessionWrite, buffer, length < 0 ? length : lengthInBytes);
+    traceWrite(buffer, length);
+    return length;
+}
+
+void RecordingDataController::closeIt()
+{
+    m_transport->closeIt();
+
+    if (m_file) {
+        ::fflush(m_file);
+    }
+}
+
+void RecordingDataController::record(SessionDirection direction, const unsigned char* buffer, int length)
+{
+    if (!m_file) {
+        return;
+    }
+
+    SessionRecord record;
+    record.timestampNs = nowNs() - m_startNs;
+    record.length = length < 0 ? -1 : length;
+    record.direction = direction;
+
+    ::fwrite(&record, sizeof(record), 1, m_file);
+
+    if (length > 0) {
+        ::fwrite(buffer, 1, length, m_file);
+    }
+
+    m_nbRecords++;
+}
+
+} // namespace SerialDV
@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RECORDINGDATACONTROLLER_H_
+#define RECORDINGDATACONTROLLER_H_
+
+#include <cstdio>
+#include <string>
+#include <stdint.h>
+
+#include "datacontroller.h"
+
+namespace SerialDV
+{
+
+/** Session file format: header then one record per transport call that moved data */
+struct SessionFileHeader
+{
+    char magic[8];    //!< "SDVSESSN"
+    uint32_t version;
+};
+
+#pragma pack(push, 1)
+struct SessionRecord
+{
+    uint64_t timestampNs; //!< since the transport was opened
+    int32_t length;       //!< number of bytes following or -1 for an error
+    uint8_t direction;    //!< SessionWrite or SessionRead
+};
+#pragma pack(pop)
+
+enum SessionDirection
+{
+    SessionWrite = 0,
+    SessionRead = 1
+};
+
+/** Wraps a transport and logs every byte written and read through it with timestamps
+ * into a session file that can be played back with ReplayDataController.
+ * Polls that returned no data are not logged.
+ */
+class SERIALDV_API RecordingDataController : public DataController {
+public:
+    /** Takes ownership of the transport
+     */
+    RecordingDataController(DataController *transport, const std::string& sessionFileName);
+    virtual ~RecordingDataController();
+
+    virtual bool open(const std::string& device, SERIAL_SPEED speed);
+
+    virtual bool initResponse();
+    virtual int  read(unsigned char* buffer, unsigned int lengthInBytes);
+    virtual int  write(const unsigned char* buffer, unsigned int lengthInBytes);
+
+    virtual void closeIt();
+
+    virtual bool isDatagram() const { return m_transport->isDatagram(); }
+
+    unsigned long long getNbRecords() const { return m_nbRecords; }
+
+private:
+    void record(SessionDirection direction, const unsigned char* buffer, int length);
+
+    DataController *m_transport;
+    std::string m_sessionFileName;
+    FILE *m_file;
+    uint64_t m_startNs;
+    unsigned long long m_nbRecords;
+};
+
+} // namespace SerialDV
+
+#endif // RECORDINGDATACONTROLLER_H_
@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "replaydatacontroller.h"
+#include "recordingdatacontroller.h"
+#include "logger.h"
+
+namespace SerialDV
+{
+
+static uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ReplayDataController::ReplayDataController(bool originalTiming) :
+    m_originalTiming(originalTiming),
+    m_position(0),
+    m_readOffset(0),
+    m_nbMismatches(0)
+{}
+
+ReplayDataController::~ReplayDataController()
+{}
+
+bool ReplayDataController::open(const std::string& sessionFileName, SERIAL_SPEED speed)
+{
+    (void) speed;
+
+    if (!m_records.empty() && (sessionFileName == m_sessionFileName)) { // reopened during recovery
+        return true;
+    }
+
+    FILE *file = ::fopen(sessionFileName.c_str(), "rb");
+
+    if (!file)
+    {
+        SERIALDV_LOG(LogError, "ReplayDataController::open: cannot open %s", sessionFileName.c_str());
+        return false;
+    }
+
+    SessionFileHeader header;
+
+    if ((::fread(&header, sizeof(header), 1, file) != 1) || (memcmp(header.magic, "SDVSESSN", sizeof(header.magic)) != 0) || (header.version != 1))
+    {
+        SERIALDV_LOG(LogError, "ReplayDataController::open: %s is not a session file", sessionFileName.c_str());
+        ::fclose(file);
+        return false;
+    }
+
+    m_records.clear();
+    m_data.clear();
+    SessionRecord sessionRecord;
+    uint64_t lastWriteNs = 0;
+
+    while (::fread(&sessionRecord, sizeof(sessionRecord), 1, file) == 1)
+    {
+        Record record;
+        record.delayNs = sessionRecord.timestampNs - lastWriteNs;
+        record.length = sessionRecord.length;
+        record.direction = sessionRecord.direction;
+        record.dataOffset = m_data.size();
+
+        if (record.length > 0)
+        {
+            m_data.resize(m_data.size() + record.length);
+
+            if (::fread(&m_data[record.dataOffset], 1, record.length, file) != (size_t) record.length) {
+                break; // truncated session
+            }
+        }
+
+        if (record.direction == SessionWrite) {
+            lastWriteNs = sessionRecord.timestampNs;
+        }
+
+        m_records.push_back(record);
+    }
+
+    ::fclose(file);
+    m_sessionFileName = sessionFileName;
+    rewind();
+
+    SERIALDV_LOG(LogInfo, "ReplayDataController::open: %u records from %s", (unsigned int) m_records.size(), sessionFileName.c_str());
+    return true;
+}
+
+void ReplayDataController::rewind()
+{
+    m_position = 0;
+    m_pending.clear();
+    m_readOffset = 0;
+    m_nbMismatches = 0;
+    queueReads(nowNs()); // received before the first write
+}
+
+void ReplayDataController::queueReads(uint64_t writeNs)
+{
+    for (; (m_position < m_records.size()) && (m_records[m_position].direction != SessionWrite); m_position++)
+    {
+        PendingRead pending = {m_position, writeNs + m_records[m_position].delayNs};
+        m_pending.push_back(pending);
+    }
+}
+
+bool ReplayDataController::initResponse()
+{
+    return true;
+}
+
+int ReplayDataController::read(unsigned char* buffer, unsigned int lengthInBytes)
+{
+    if (m_pending.empty()) {
+        return 0; // nothing was received at this point of the session
+    }
+
+    const Record& record = m_records[m_pending.front().record];
+
+    if (m_originalTiming && (nowNs() < m_pending.front().readableNs)) {
+        return 0;
+    }
+
+    if (record.length < 0)
+    {
+        m_pending.pop_front();
+        return -1;
+    }
+
+    unsigned int length = record.length - m_readOffset;
+    length = length < lengthInBytes ? length : lengthInBytes;
+    if (length > 0) { // a zero length record may be the last one with no data behind it
+        memcpy(buffer, m_data.data() + record.dataOffset + m_readOffset, length);
+    }
+
+    m_readOffset += length;
+
+    if (m_readOffset == (unsigned int) record.length)
+    {
+        m_pending.pop_front();
+        m_readOffset = 0;
+    }
+
+    return length;
+}
+
+int ReplayDataController::write(const unsigned char* buffer, unsigned int lengthInBytes)
+{
+    if (m_position >= m_records.size())
+    {
+        SERIALDV_LOG(LogError, "ReplayDataController::write: end of session");
+        return -1;
+    }
+
+    const Record& record = m_records[m_position++];
+    queueReads(nowNs());
+
+    if ((record.length != (int32_t) lengthInBytes)
+     || ((lengthInBytes > 0) && (memcmp(buffer, m_data.data() + record.dataOffset, lengthInBytes) != 0))) {
+        m_nbMismatches++;
+    }
+
+    int length = record.length < 0 ? -1 : (int) lengthInBytes;
+    traceWrite(buffer, length);
+    return length;
+}
+
+void ReplayDataController::closeIt()
+{}
+
+} // namespace SerialDV
@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef REPLAYDATACONTROLLER_H_
+#define REPLAYDATACONTROLLER_H_
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "datacontroller.h"
+
+namespace SerialDV
+{
+
+/** Plays back a session recorded with RecordingDataController in place of a device.
+ * The device name given to open() is the session file name. Each write consumes the
+ * next recorded write and queues the responses recorded after it. Like in the device
+ * responses that are not read yet stay queued so that several writes can be made before
+ * reading (pipelined processing). With original timing a response becomes readable after
+ * the same delay from its write as in the recorded session, else immediately.
+ */
+class SERIALDV_API ReplayDataController : public DataController {
+public:
+    explicit ReplayDataController(bool originalTiming = true);
+    virtual ~ReplayDataController();
+
+    virtual bool open(const std::string& sessionFileName, SERIAL_SPEED speed);
+
+    virtual bool initResponse();
+    virtual int  read(unsigned char* buffer, unsigned int lengthInBytes);
+    virtual int  write(const unsigned char* buffer, unsigned int lengthInBytes);
+
+    virtual void closeIt();
+
+    /** Restart playback from the beginning of the session
+     */
+    void rewind();
+    bool isFinished() const { return (m_position >= m_records.size()) && m_pending.empty(); }
+    /** Writes that differ from the recorded ones
+     */
+    unsigned long long getNbMismatches() const { return m_nbMismatches; }
+
+private:
+    struct Record
+    {
+        uint64_t delayNs; //!< since the previous write
+        int32_t length;
+        uint8_t direction;
+        unsigned int dataOffset;
+    };
+
+    struct PendingRead
+    {
+        unsigned int record;
+        uint64_t readableNs;
+    };
+
+    bool m_originalTiming;
+    std::string m_sessionFileName;
+    std::vector<Record> m_records;
+    std::vector<unsigned char> m_data;
+    unsigned int m_position;   //!< next record to play
+    std::deque<PendingRead> m_pending; //!< responses of the writes made that were not read
+    unsigned int m_readOffset; //!< bytes of the first pending read already returned
+    unsigned long long m_nbMismatches;
+
+    void queueReads(uint64_t writeNs);
+};
+
+} // namespace SerialDV
+
+#endif // REPLAYDATACONTROLLER_H_
@@ -14,7 +14,11 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.          //
 ///////////////////////////////////////////////////////////////////////////////////
 
+#include <typeinfo>
+
 #include "serialdatacontroller.h"
+#include "logger.h"
+#include "packetframer.h"
 
 #include <sys/types.h>
 #include <stdio.h>
@@ -73,16 +77,17 @@ bool SerialDataController::open(const std::string& device, SERIAL_SPEED speed)
     m_handle = ::CreateFile(m_device.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
     if (m_handle == INVALID_HANDLE_VALUE)
     {
-        fprintf(stderr, "Cannot open device - %s, err=%04lx\n", m_device.c_str(), ::GetLastError());
+        SERIALDV_LOG(LogError, "Cannot open device - %s, err=%04lx", m_device.c_str(), ::GetLastError());
         return false;
     }
 
     DCB dcb;
     if (::GetCommState(m_handle, &dcb) == 0)
     {
-        fprintf(stderr, "Cannot get the attributes for %s, err=%04lx\n", m_device.c_str(), ::GetLastError());
+        SERIALDV_LOG(LogError, "Cannot get the attributes for %s, err=%04lx", m_device.c_str(), ::GetLastError());
         ::ClearCommError(m_handle, &errCode, NULL);
         ::CloseHandle(m_handle);
+        m_handle = INVALID_HANDLE_VALUE;
         return false;
     }
 
@@ -100,18 +105,20 @@ bool SerialDataController::open(const std::string& device, SERIAL_SPEED speed)
 
     if (::SetCommState(m_handle, &dcb) == 0)
     {
-        fprintf(stderr, "Cannot set the attributes for %s, err=%04lx\n", m_device.c_str(), ::GetLastError());
+        SERIALDV_LOG(LogError, "Cannot set the attributes for %s, err=%04lx", m_device.c_str(), ::GetLastError());
         ::ClearCommError(m_handle, &errCode, NULL);
         ::CloseHandle(m_handle);
+        m_handle = INVALID_HANDLE_VALUE;
         return false;
     }
 
     COMMTIMEOUTS timeouts;
     if (!::GetCommTimeouts(m_handle, &timeouts))
     {
-        fprintf(stderr, "Cannot get the timeouts for %s, err=%04lx\n", m_device.c_str(), ::GetLastError());
+        SERIALDV_LOG(LogError, "Cannot get the timeouts for %s, err=%04lx", m_device.c_str(), ::GetLastError());
         ::ClearCommError(m_handle, &errCode, NULL);
         ::CloseHandle(m_handle);
+        m_handle = INVALID_HANDLE_VALUE;
         return false;
     }
 
@@ -121,25 +128,28 @@ bool SerialDataController::open(const std::string& device, SERIAL_SPEED speed)
 
     if (!::SetCommTimeouts(m_handle, &timeouts))
     {
-        fprintf(stderr, "Cannot set the timeouts for %s, err=%04lx\n", m_device.c_str(), ::GetLastError());
+        SERIALDV_LOG(LogError, "Cannot set the timeouts for %s, err=%04lx", m_device.c_str(), ::GetLastError());
         ::ClearCommError(m_handle, &errCode, NULL);
         ::CloseHandle(m_handle);
+        m_handle = INVALID_HANDLE_VALUE;
         return false;
     }
 
     if (::EscapeCommFunction(m_handle, CLRDTR) == 0)
     {
-        fprintf(stderr, "Cannot clear DTR for %s, err=%04lx\n", m_device.c_str(), ::GetLastError());
+        SERIALDV_LOG(LogError, "Cannot clear DTR for %s, err=%04lx", m_device.c_str(), ::GetLastError());
         ::ClearCommError(m_handle, &errCode, NULL);
         ::CloseHandle(m_handle);
+        m_handle = INVALID_HANDLE_VALUE;
         return false;
     }
 
     if (::EscapeCommFunction(m_handle, CLRRTS) == 0)
     {
-        fprintf(stderr, "Cannot clear RTS for %s, err=%04lx\n", m_device.c_str(), ::GetLastError());
+        SERIALDV_LOG(LogError, "Cannot clear RTS for %s, err=%04lx", m_device.c_str(), ::GetLastError());
         ::ClearCommError(m_handle, &errCode, NULL);
         ::CloseHandle(m_handle);
+        m_handle = INVALID_HANDLE_VALUE;
         return false;
     }
 
@@ -218,7 +228,7 @@ int SerialDataController::readNonblock(unsigned char* buffer, unsigned int lengt
         DWORD error = ::GetLastError();
         if (error != ERROR_IO_PENDING)
         {
-            fprintf(stderr, "Error from ReadFile: %04lx\n", error);
+            SERIALDV_LOG(LogError, "Error from ReadFile: %04lx", error);
             return -1;
         }
 
@@ -233,7 +243,7 @@ int SerialDataController::readNonblock(unsigned char* buffer, unsigned int lengt
     res = ::GetOverlappedResult(m_handle, &m_readOverlapped, &bytes, TRUE);
     if (!res)
     {
-        fprintf(stderr, "Error from GetOverlappedResult (ReadFile): %04lx\n", ::GetLastError());
+        SERIALDV_LOG(LogError, "Error from GetOverlappedResult (ReadFile): %04lx", ::GetLastError());
         return -1;
     }
 
@@ -262,14 +272,16 @@ int SerialDataController::write(const unsigned char* buffer, unsigned int length
             DWORD error = ::GetLastError();
             if (error != ERROR_IO_PENDING)
             {
-                fprintf(stderr, "Error from WriteFile: %04lx\n", error);
+                SERIALDV_LOG(LogError, "Error from WriteFile: %04lx", error);
+                traceWrite(buffer, -1);
                 return -1;
             }
 
             res = ::GetOverlappedResult(m_handle, &m_writeOverlapped, &bytes, TRUE);
             if (!res)
             {
-                fprintf(stderr, "Error from GetOverlappedResult (WriteFile): %04lx\n", ::GetLastError());
+                SERIALDV_LOG(LogError, "Error from GetOverlappedResult (WriteFile): %04lx", ::GetLastError());
+                traceWrite(buffer, -1);
                 return -1;
             }
         }
@@ -277,12 +289,15 @@ int SerialDataController::write(const unsigned char* buffer, unsigned int length
         ptr += bytes;
     }
 
+    traceWrite(buffer, length);
     return int(length);
 }
 
 void SerialDataController::closeIt()
 {
-    assert(m_handle != INVALID_HANDLE_VALUE);
+    if (m_handle == INVALID_HANDLE_VALUE) { // failed open
+        return;
+    }
 
     ::CloseHandle(m_handle);
     m_handle = INVALID_HANDLE_VALUE;
@@ -315,14 +330,15 @@ bool SerialDataController::open(const std::string& device, SERIAL_SPEED speed)
 
     if (m_fd < 0)
     {
-        fprintf(stderr, "SerialDataController::open: Cannot open device - %s", m_device.c_str());
+        SERIALDV_LOG(LogError, "SerialDataController::open: Cannot open device - %s", m_device.c_str());
         return false;
     }
 
     if (::isatty(m_fd) == 0)
     {
-        fprintf(stderr, "SerialDataController::open: %s is not a TTY device", m_device.c_str());
+        SERIALDV_LOG(LogError, "SerialDataController::open: %s is not a TTY device", m_device.c_str());
         ::close(m_fd);
+        m_fd = -1;
         return false;
     }
 
@@ -338,13 +354,15 @@ bool SerialDataController::open(const std::string& device, SERIAL_SPEED speed)
     struct serial_struct serial;
 
     if (::ioctl(m_fd, TIOCGSERIAL, &serial) < 0) {
-        fprintf(stderr, "SerialDataController::open: ioctl: Cannot get serial_struct\n");
+        SERIALDV_LOG(LogError, "SerialDataController::open: ioctl: Cannot get serial_struct");
     }
 
     serial.flags |= ASYNC_LOW_LATENCY;
 
     if (::ioctl(m_fd, TIOCSSERIAL, &serial) < 0) {
-        fprintf(stderr, "SerialDataController::open: ioctl: Cannot set ASYNC_LOW_LATENCY\n");
+        SERIALDV_LOG(LogError, "SerialDataController::open: ioctl: Cannot set ASYNC_LOW_LATENCY");
+        ::close(m_fd);
+        m_fd = -1;
         return false;
     }
 
@@ -354,8 +372,9 @@ bool SerialDataController::open(const std::string& device, SERIAL_SPEED speed)
 
     if (::tcgetattr(m_fd, &termios) < 0)
     {
-        fprintf(stderr, "SerialDataController::open: Cannot get the attributes for %s", m_device.c_str());
+        SERIALDV_LOG(LogError, "SerialDataController::open: Cannot get the attributes for %s", m_device.c_str());
         ::close(m_fd);
+        m_fd = -1;
         return false;
     }
 
@@ -407,19 +426,21 @@ bool SerialDataController::open(const std::string& device, SERIAL_SPEED speed)
         ::cfsetispeed(&termios, B460800);
         break;
     default:
-        fprintf(stderr, "SerialDataController::open: Unsupported serial port speed - %d\n", int(m_speed));
+        SERIALDV_LOG(LogError, "SerialDataController::open: Unsupported serial port speed - %d", int(m_speed));
         ::close(m_fd);
+        m_fd = -1;
         return false;
     }
 
     if (::tcsetattr(m_fd, TCSANOW, &termios) < 0)
     {
-        fprintf(stderr, "SerialDataController::open: Cannot set the attributes for %s\n", m_device.c_str());
+        SERIALDV_LOG(LogError, "SerialDataController::open: Cannot set the attributes for %s", m_device.c_str());
         ::close(m_fd);
+        m_fd = -1;
         return false;
     }
 
-    fprintf(stderr, "SerialDataController::open: opened %s at speed %d\n",  m_device.c_str(), int(m_speed));
+    SERIALDV_LOG(LogInfo, "SerialDataController::open: opened %s at speed %d",  m_device.c_str(), int(m_speed));
 
     return true;
 }
@@ -457,12 +478,22 @@ int SerialDataController::read(unsigned char* buffer, unsigned int lengthInBytes
         }
         else
         {
-            n = ::select(m_fd + 1, &fds, 0, 0, 0);
+            // do not hang on a device that stops in the middle of a packet
+            struct timeval tv;
+
+            tv.tv_sec = 0;
+            tv.tv_usec = 100000;
+
+            n = ::select(m_fd + 1, &fds, 0, 0, &tv);
+
+            if (n == 0) {
+                return offset;
+            }
         }
 
         if (n < 0)
         {
-            fprintf(stderr, "SerialDataController::read: Error from select(), errno=%d", errno);
+            SERIALDV_LOG(LogError, "SerialDataController::read: Error from select(), errno=%d", errno);
             return -1;
         }
 
@@ -474,7 +505,7 @@ int SerialDataController::read(unsigned char* buffer, unsigned int lengthInBytes
             {
                 if (errno != EAGAIN)
                 {
-                    fprintf(stderr, "SerialDataController::read: Error from read(), errno=%d", errno);
+                    SERIALDV_LOG(LogError, "SerialDataController::read: Error from read(), errno=%d", errno);
                     return -1;
                 }
             }
@@ -506,7 +537,8 @@ int SerialDataController::write(const unsigned char* buffer, unsigned int length
         {
             if (errno != EAGAIN)
             {
-                fprintf(stderr, "SerialDataController::write: Error returned from write(), errno=%d", errno);
+                SERIALDV_LOG(LogError, "SerialDataController::write: Error returned from write(), errno=%d", errno);
+                traceWrite(buffer, -1);
                 return -1;
             }
         }
@@ -516,12 +548,15 @@ int SerialDataController::write(const unsigned char* buffer, unsigned int length
         }
     }
 
+    traceWrite(buffer, lengthInBytes);
     return lengthInBytes;
 }
 
 void SerialDataController::closeIt()
 {
-    assert(m_fd != -1);
+    if (m_fd == -1) { // failed open
+        return;
+    }
 
     ::close (m_fd);
 
@@ -532,6 +567,17 @@ void SerialDataController::closeIt()
 
 #endif // WINDOWS
 
+int SerialDataController::readPacket(PacketView& packet, unsigned int timeoutUs)
+{
+    if (typeid(*this) == typeid(SerialDataController))
+    {
+        DirectStream<SerialDataController> stream(*this);
+        return readFramedPacket(stream, packet, timeoutUs);
+    }
+
+    return readFramedPacket(*this, packet, timeoutUs); // derived class: keep its overrides
+}
+
 bool SerialDataController::initResponse()
 {
     return true; // Do nothing for serial
@@ -38,6 +38,9 @@ public:
 
     virtual void closeIt();
 
+    virtual int readPacket(PacketView& packet, unsigned int timeoutUs);
+    virtual int writePacket(const unsigned char* packet, unsigned int length) { return write(packet, length); }
+
 private:
     std::string    m_device;
     SERIAL_SPEED   m_speed;
@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cassert>
+#include <stdint.h>
+
+#include "dvcontroller.h"
+#include "silencedetector.h"
+
+namespace SerialDV
+{
+
+SilenceDetector::SilenceDetector(float thresholdDb, unsigned int hangoverFrames) :
+        m_thresholdDb(thresholdDb),
+        m_hangoverFrames(hangoverFrames),
+        m_hangoverCount(hangoverFrames),
+        m_nbFrames(0),
+        m_nbSilentFrames(0)
+{
+    double fullScale = 32768.0 * 32768.0 * MBE_AUDIO_BLOCK_SIZE;
+    m_thresholdEnergy = (long long) (fullScale * pow(10.0, thresholdDb / 10.0));
+}
+
+SilenceDetector::~SilenceDetector()
+{
+}
+
+long long SilenceDetector::frameEnergy(const short *audioFrame)
+{
+    assert(audioFrame != 0);
+    int64_t energy = 0;
+
+    // plain loop on purpose so that it is vectorized by the compiler (-ftree-vectorize)
+    for (unsigned int i = 0; i < MBE_AUDIO_BLOCK_SIZE; i++) {
+        energy += (int32_t) audioFrame[i] * (int32_t) audioFrame[i];
+    }
+
+    return energy;
+}
+
+bool SilenceDetector::isSilence(const short *audioFrame)
+{
+    m_nbFrames++;
+
+    if (frameEnergy(audioFrame) > m_thresholdEnergy)
+    {
+        m_hangoverCount = m_hangoverFrames;
+        return false;
+    }
+
+    if (m_hangoverCount > 0)
+    {
+        m_hangoverCount--;
+        return false;
+    }
+
+    m_nbSilentFrames++;
+    return true;
+}
+
+void SilenceDetector::reset()
+{
+    m_hangoverCount = m_hangoverFrames;
+    m_nbFrames = 0;
+    m_nbSilentFrames = 0;
+}
+
+} // namespace SerialDV
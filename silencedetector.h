@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SILENCEDETECTOR_H_
+#define SILENCEDETECTOR_H_
+
+#include "serialdv_export.h"
+
+namespace SerialDV
+{
+
+/** Frame energy based voice activity detection on 160 samples audio frames.
+ * A frame is declared silent when its mean energy is below the threshold and
+ * no speech frame was seen in the last hangover frames so that speech tails
+ * and onsets are not clipped.
+ */
+class SERIALDV_API SilenceDetector
+{
+public:
+    /** Threshold is in dB relative to full scale i.e. a mean energy of 32768^2.
+     */
+    SilenceDetector(float thresholdDb, unsigned int hangoverFrames);
+    ~SilenceDetector();
+
+    bool isSilence(const short *audioFrame);
+    void reset();
+
+    float getThresholdDb() const { return m_thresholdDb; }
+    unsigned int getHangoverFrames() const { return m_hangoverFrames; }
+    unsigned long long getNbFrames() const { return m_nbFrames; }
+    unsigned long long getNbSilentFrames() const { return m_nbSilentFrames; }
+
+    /** Sum of squared samples of one MBE_AUDIO_BLOCK_SIZE frame
+     */
+    static long long frameEnergy(const short *audioFrame);
+
+private:
+    float m_thresholdDb;
+    long long m_thresholdEnergy;    //!< threshold as sum of squares over a frame
+    unsigned int m_hangoverFrames;
+    unsigned int m_hangoverCount;   //!< frames left before silence can be declared
+    unsigned long long m_nbFrames;
+    unsigned long long m_nbSilentFrames;
+};
+
+} // namespace SerialDV
+
+#endif /* SILENCEDETECTOR_H_ */
@@ -0,0 +1,453 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+
+#include "socketdatacontroller.h"
+#include "dvcontroller.h"
+#include "logger.h"
+#include "tracering.h"
+
+namespace SerialDV
+{
+
+SocketDataController::SocketDataController() :
+    m_fd(-1),
+    m_rxBegin(0),
+    m_rxEnd(0),
+    m_txLength(0)
+{}
+
+SocketDataController::~SocketDataController()
+{
+    closeIt();
+}
+
+bool SocketDataController::isSocketUri(const std::string& device)
+{
+    return (device.compare(0, 5, "unix:") == 0) || (device.compare(0, 6, "tcp://") == 0);
+}
+
+bool SocketDataController::open(const std::string& uri, SERIAL_SPEED speed)
+{
+    (void) speed;
+    closeIt();
+    bool res;
+
+    if (uri.compare(0, 5, "unix:") == 0) {
+        res = connectUnix(uri.substr(5));
+    } else if (uri.compare(0, 6, "tcp://") == 0) {
+        res = connectTcp(uri.substr(6));
+    } else {
+        SERIALDV_LOG(LogError, "SocketDataController::open: unsupported URI: %s", uri.c_str());
+        return false;
+    }
+
+    if (!res) {
+        return false;
+    }
+
+    SERIALDV_LOG(LogInfo, "SocketDataController::open: connected to %s", uri.c_str());
+    return true;
+}
+
+bool SocketDataController::connectUnix(const std::string& path)
+{
+    struct sockaddr_un address;
+
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        SERIALDV_LOG(LogError, "SocketDataController::connectUnix: path too long: %s", path.c_str());
+        return false;
+    }
+
+    m_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (m_fd < 0)
+    {
+        SERIALDV_LOG(LogError, "SocketDataController::connectUnix: cannot create socket: %s", strerror(errno));
+        return false;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, path.c_str(), path.size());
+
+    if (!connectSocket((struct sockaddr *) &address, sizeof(address)))
+    {
+        SERIALDV_LOG(LogError, "SocketDataController::connectUnix: cannot connect to %s: %s", path.c_str(), strerror(errno));
+        closeIt();
+        return false;
+    }
+
+    return true;
+}
+
+bool SocketDataController::connectTcp(const std::string& hostAndPort)
+{
+    std::string::size_type colon = hostAndPort.rfind(':');
+
+    if (colon == std::string::npos)
+    {
+        SERIALDV_LOG(LogError, "SocketDataController::connectTcp: no port in %s", hostAndPort.c_str());
+        return false;
+    }
+
+    std::string host = hostAndPort.substr(0, colon);
+    std::string port = hostAndPort.substr(colon + 1);
+
+    if ((host.size() > 1) && (host[0] == '[') && (host[host.size() - 1] == ']')) { // IPv6 literal
+        host = host.substr(1, host.size() - 2);
+    }
+
+    struct addrinfo hints, *addresses;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    int rc = ::getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses);
+
+    if (rc != 0)
+    {
+        SERIALDV_LOG(LogError, "SocketDataController::connectTcp: cannot resolve %s: %s", hostAndPort.c_str(), gai_strerror(rc));
+        return false;
+    }
+
+    for (struct addrinfo *address = addresses; address; address = address->ai_next)
+    {
+        m_fd = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+
+        if (m_fd < 0) {
+            continue;
+        }
+
+        if (connectSocket(address->ai_addr, address->ai_addrlen)) {
+            break;
+        }
+
+        closeIt();
+    }
+
+    ::freeaddrinfo(addresses);
+
+    if (m_fd < 0)
+    {
+        SERIALDV_LOG(LogError, "SocketDataController::connectTcp: cannot connect to %s", hostAndPort.c_str());
+        return false;
+    }
+
+    int flag = 1;
+    ::setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+    return true;
+}
+
+bool SocketDataController::connectSocket(const struct sockaddr *address, unsigned int addressLength)
+{
+    // non blocking so that an unreachable peer does not hang open()
+    ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+
+    if (::connect(m_fd, address, addressLength) == 0) {
+        return true;
+    }
+
+    if ((errno != EINPROGRESS) && (errno != EAGAIN)) {
+        return false;
+    }
+
+    struct pollfd pfd = {m_fd, POLLOUT, 0};
+    int rc;
+
+    do {
+        rc = ::poll(&pfd, 1, CONNECT_TIMEOUT_MS);
+    } while ((rc < 0) && (errno == EINTR));
+
+    if (rc == 0) {
+        errno = ETIMEDOUT;
+    }
+
+    if (rc <= 0) {
+        return false;
+    }
+
+    int error = 0;
+    socklen_t length = sizeof(error);
+
+    if ((::getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0) || (error != 0))
+    {
+        errno = error != 0 ? error : errno;
+        return false;
+    }
+
+    return true;
+}
+
+void SocketDataController::closeIt()
+{
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    m_rxBegin = 0;
+    m_rxEnd = 0;
+    m_txLength = 0;
+}
+
+bool SocketDataController::flush()
+{
+    bool res = sendAll(m_txBuffer, m_txLength);
+    m_txLength = 0;
+    return res;
+}
+
+bool SocketDataController::sendAll(const unsigned char* buffer, unsigned int length)
+{
+    unsigned int sent = 0;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SEND_TIMEOUT_MS);
+
+    while (sent < length)
+    {
+        ssize_t n = ::send(m_fd, buffer + sent, length - sent, MSG_NOSIGNAL);
+
+        if (n > 0)
+        {
+            sent += n;
+        }
+        else if ((n < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+        {
+            int remainingMs = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+
+            if (remainingMs <= 0)
+            {
+                SERIALDV_LOG(LogError, "SocketDataController::sendAll: peer not accepting data");
+                return false;
+            }
+
+            struct pollfd pfd = {m_fd, POLLOUT, 0};
+            ::poll(&pfd, 1, remainingMs);
+        }
+        else if ((n < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        else
+        {
+            SERIALDV_LOG(LogError, "SocketDataController::sendAll: send error: %s", strerror(errno));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int SocketDataController::write(const unsigned char* buffer, unsigned int lengthInBytes)
+{
+    if (m_fd < 0) {
+        return -1;
+    }
+
+    if ((m_txLength + lengthInBytes > TX_BUFFER_LENGTH) && !flush()) {
+        return -1;
+    }
+
+    if (lengthInBytes > TX_BUFFER_LENGTH) // too large to be coalesced
+    {
+        int n = sendAll(buffer, lengthInBytes) ? (int) lengthInBytes : -1;
+        traceWrite(buffer, n);
+        return n;
+    }
+
+    memcpy(m_txBuffer + m_txLength, buffer, lengthInBytes);
+    m_txLength += lengthInBytes;
+    traceWrite(buffer, lengthInBytes);
+    return lengthInBytes;
+}
+
+int SocketDataController::fill()
+{
+    if (m_rxBegin == m_rxEnd)
+    {
+        m_rxBegin = 0;
+        m_rxEnd = 0;
+    }
+    else if (m_rxBegin > 0) // packet views handed out before are no longer valid
+    {
+        memmove(m_rxBuffer, m_rxBuffer + m_rxBegin, m_rxEnd - m_rxBegin);
+        m_rxEnd -= m_rxBegin;
+        m_rxBegin = 0;
+    }
+
+    if (m_rxEnd == RX_BUFFER_LENGTH) {
+        return 0;
+    }
+
+    ssize_t n = ::recv(m_fd, m_rxBuffer + m_rxEnd, RX_BUFFER_LENGTH - m_rxEnd, 0);
+
+    if (n > 0)
+    {
+        m_rxEnd += n;
+        return n;
+    }
+    else if (n == 0)
+    {
+        SERIALDV_LOG(LogError, "SocketDataController::fill: connection closed by peer");
+        return -1;
+    }
+    else if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))
+    {
+        return 0;
+    }
+    else
+    {
+        SERIALDV_LOG(LogError, "SocketDataController::fill: receive error: %s", strerror(errno));
+        return -1;
+    }
+}
+
+bool SocketDataController::waitReadable(unsigned int timeoutUs)
+{
+    struct pollfd pfd = {m_fd, POLLIN, 0};
+    int timeoutMs = (timeoutUs + 999) / 1000;
+    return ::poll(&pfd, 1, timeoutMs) > 0;
+}
+
+bool SocketDataController::initResponse()
+{
+    return (m_fd >= 0) && flush();
+}
+
+int SocketDataController::read(unsigned char* buffer, unsigned int lengthInBytes)
+{
+    if ((m_fd < 0) || !flush()) {
+        return -1;
+    }
+
+    if ((m_rxBegin == m_rxEnd) && (fill() < 0)) {
+        return -1;
+    }
+
+    unsigned int length = m_rxEnd - m_rxBegin;
+    length = length < lengthInBytes ? length : lengthInBytes;
+    memcpy(buffer, m_rxBuffer + m_rxBegin, length);
+    m_rxBegin += length;
+    return length;
+}
+
+int SocketDataController::readPacket(PacketView& packet, unsigned int timeoutUs)
+{
+    if ((m_fd < 0) || !flush())
+    {
+        if (m_trace) {
+            m_trace->record(TraceError);
+        }
+
+        return -1;
+    }
+
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeoutUs);
+    bool firstByteSeen = false;
+
+    while (true)
+    {
+        // skip anything that does not start a packet
+        while ((m_rxBegin < m_rxEnd) && (m_rxBuffer[m_rxBegin] != DV3000_START_BYTE)) {
+            m_rxBegin++;
+        }
+
+        unsigned int available = m_rxEnd - m_rxBegin;
+
+        if ((available > 0) && !firstByteSeen)
+        {
+            if (m_trace) {
+                m_trace->record(TraceFirstByte);
+            }
+
+            firstByteSeen = true;
+        }
+
+        if (available >= DV3000_HEADER_LEN)
+        {
+            const unsigned char *header = m_rxBuffer + m_rxBegin;
+            unsigned int length = DV3000_HEADER_LEN + header[1] * 256 + header[2];
+
+            if (length > BUFFER_LENGTH)
+            {
+                SERIALDV_LOG(LogError, "SocketDataController::readPacket: packet too long (%u)", length);
+                m_rxBegin++; // resynchronize on next start byte
+                return -1;
+            }
+
+            if (available >= length)
+            {
+                packet.data = header;
+                packet.length = length;
+                m_rxBegin += length;
+
+                if (m_trace) {
+                    m_trace->record(TracePacketComplete, header[3], length);
+                }
+
+                return length;
+            }
+        }
+
+        int n = fill();
+
+        if (n < 0)
+        {
+            if (m_trace) {
+                m_trace->record(TraceError);
+            }
+
+            return -1;
+        }
+        else if (n > 0)
+        {
+            continue;
+        }
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        if ((now >= deadline) || !waitReadable(std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count()))
+        {
+            if (std::chrono::steady_clock::now() < deadline) { // poll interrupted
+                continue;
+            }
+
+            SERIALDV_LOG(LogWarning, "SocketDataController::readPacket: Timeout");
+
+            if (m_trace) {
+                unsigned int available = m_rxEnd - m_rxBegin;
+                m_trace->record(TraceTimeout, TraceRing::NO_PACKET_TYPE, 0, available >= DV3000_HEADER_LEN ? 2 : available > 0 ? 1 : 0);
+            }
+
+            return 0;
+        }
+    }
+}
+
+} // namespace SerialDV
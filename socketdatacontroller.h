@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SOCKETDATACONTROLLER_H_
+#define SOCKETDATACONTROLLER_H_
+
+#include <string>
+#include "datacontroller.h"
+
+struct sockaddr;
+
+namespace SerialDV
+{
+
+/** Stream socket transport to a vocoder server. The device is given as an URI:
+ * - unix:/run/dv.sock for a Unix domain socket
+ * - tcp://host:port for TCP (Nagle's algorithm is disabled)
+ * Received bytes are buffered so that packets are parsed in place and written
+ * packets are coalesced until a response is awaited.
+ */
+class SERIALDV_API SocketDataController : public DataController {
+public:
+    static const unsigned int RX_BUFFER_LENGTH = 8192U;
+    static const unsigned int TX_BUFFER_LENGTH = 4096U;
+    static const unsigned int CONNECT_TIMEOUT_MS = 3000U;
+    static const unsigned int SEND_TIMEOUT_MS = 1000U;   //!< maximum wait for a stalled peer to accept data
+
+    SocketDataController();
+    virtual ~SocketDataController();
+
+    virtual bool open(const std::string& uri, SERIAL_SPEED speed);
+
+    virtual bool initResponse();
+    virtual int  read(unsigned char* buffer, unsigned int lengthInBytes);
+    virtual int  write(const unsigned char* buffer, unsigned int lengthInBytes);
+
+    virtual void closeIt();
+
+    virtual int readPacket(PacketView& packet, unsigned int timeoutUs);
+    virtual int writePacket(const unsigned char* packet, unsigned int length) { return write(packet, length); }
+
+    /** Send the coalesced packets
+     */
+    bool flush();
+
+    static bool isSocketUri(const std::string& device);
+
+private:
+    bool connectUnix(const std::string& path);
+    bool connectTcp(const std::string& hostAndPort);
+    bool connectSocket(const struct sockaddr *address, unsigned int addressLength);
+    bool sendAll(const unsigned char* buffer, unsigned int length);
+    int fill(); //!< receive what is available. Returns number of bytes or -1 on error
+    bool waitReadable(unsigned int timeoutUs);
+
+    int m_fd;
+    unsigned char m_rxBuffer[RX_BUFFER_LENGTH];
+    unsigned int m_rxBegin; //!< first unread byte
+    unsigned int m_rxEnd;   //!< end of received bytes
+    unsigned char m_txBuffer[TX_BUFFER_LENGTH];
+    unsigned int m_txLength;
+};
+
+} // namespace SerialDV
+
+#endif // SOCKETDATACONTROLLER_H_
@@ -0,0 +1,232 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "tracering.h"
+
+namespace SerialDV
+{
+
+namespace
+{
+
+const char TRACE_MAGIC[8] = {'S', 'D', 'V', 'T', 'R', 'A', 'C', 'E'};
+const uint32_t TRACE_VERSION = 1;
+
+struct TraceFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t nbEvents;
+};
+
+} // anonymous namespace
+
+TraceRing::TraceRing(unsigned int capacity) :
+    m_mask(0),
+    m_index(0)
+{
+    unsigned int size = 1;
+
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    m_events.resize(size);
+    m_mask = size - 1;
+}
+
+uint64_t TraceRing::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TraceRing::snapshot(std::vector<TraceEvent>& events) const
+{
+    uint64_t end = m_index.load(std::memory_order_acquire);
+    uint64_t begin = end > m_events.size() ? end - m_events.size() : 0;
+
+    events.clear();
+    events.reserve(end - begin);
+
+    for (uint64_t i = begin; i < end; i++) {
+        events.push_back(m_events[i & m_mask]);
+    }
+}
+
+bool TraceRing::save(const std::string& fileName) const
+{
+    std::vector<TraceEvent> events;
+    snapshot(events);
+
+    FILE *file = ::fopen(fileName.c_str(), "wb");
+
+    if (!file) {
+        return false;
+    }
+
+    TraceFileHeader header;
+    memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    header.version = TRACE_VERSION;
+    header.nbEvents = events.size();
+
+    bool ok = (::fwrite(&header, sizeof(header), 1, file) == 1)
+        && (events.empty() || (::fwrite(events.data(), sizeof(TraceEvent), events.size(), file) == events.size()));
+
+    return (::fclose(file) == 0) && ok;
+}
+
+bool TraceRing::load(const std::string& fileName, std::vector<TraceEvent>& events)
+{
+    FILE *file = ::fopen(fileName.c_str(), "rb");
+
+    if (!file) {
+        return false;
+    }
+
+    TraceFileHeader header;
+    bool ok = (::fread(&header, sizeof(header), 1, file) == 1)
+        && (memcmp(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0)
+        && (header.version == TRACE_VERSION);
+
+    if (ok)
+    {
+        // a corrupt header must not make us allocate more than the file holds
+        long begin = ::ftell(file);
+        ok = (begin >= 0) && (::fseek(file, 0, SEEK_END) == 0);
+        long end = ok ? ::ftell(file) : -1;
+        ok = ok && (end >= begin) && (::fseek(file, begin, SEEK_SET) == 0)
+            && ((uint64_t) header.nbEvents <= (uint64_t) (end - begin) / sizeof(TraceEvent));
+    }
+
+    if (ok)
+    {
+        events.resize(header.nbEvents);
+        ok = events.empty() || (::fread(events.data(), sizeof(TraceEvent), events.size(), file) == events.size());
+    }
+
+    ::fclose(file);
+    return ok;
+}
+
+const char *TraceRing::getEventName(TraceEventType type)
+{
+    switch (type)
+    {
+    case TraceWrite:
+        return "write";
+    case TraceFirstByte:
+        return "first byte";
+    case TracePacketComplete:
+        return "packet complete";
+    case TraceRateChange:
+        return "rate change";
+    case TraceTimeout:
+        return "timeout";
+    case TraceResync:
+        return "resync";
+    case TraceError:
+        return "error";
+    default:
+        return "unknown";
+    }
+}
+
+static std::string jsonEscape(const std::string& text)
+{
+    std::string escaped;
+
+    for (unsigned int i = 0; i < text.size(); i++)
+    {
+        unsigned char c = text[i];
+
+        if ((c == '"') || (c == '\\'))
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (c < 0x20)
+        {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+
+    return escaped;
+}
+
+bool TraceRing::toChromeJson(const std::vector<TraceEvent>& events, const std::string& fileName, const std::string& processName)
+{
+    FILE *file = ::fopen(fileName.c_str(), "w");
+
+    if (!file) {
+        return false;
+    }
+
+    uint64_t origin = events.empty() ? 0 : events[0].timestampNs;
+    const TraceEvent *lastWrite = nullptr;
+    const TraceEvent *lastFirstByte = nullptr;
+
+    ::fprintf(file, "{\"traceEvents\":[\n");
+    ::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"%s\"}}", jsonEscape(processName).c_str());
+
+    for (unsigned int i = 0; i < events.size(); i++)
+    {
+        const TraceEvent& event = events[i];
+        double ts = (event.timestampNs - origin) / 1000.0;
+
+        ::fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"serialdv\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":1,\"ts\":%.3f,"
+            "\"args\":{\"packetType\":%u,\"length\":%u,\"value\":%u}}",
+            getEventName((TraceEventType) event.type), ts, event.packetType, event.length, event.value);
+
+        // spans show where the time of a transaction went: device processing then transfer of the response
+        if (event.type == TraceWrite)
+        {
+            lastWrite = &event;
+        }
+        else if ((event.type == TraceFirstByte) && lastWrite)
+        {
+            ::fprintf(file, ",\n{\"name\":\"device\",\"cat\":\"serialdv\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,"
+                "\"args\":{\"packetType\":%u}}",
+                (lastWrite->timestampNs - origin) / 1000.0, (event.timestampNs - lastWrite->timestampNs) / 1000.0,
+                lastWrite->packetType);
+            lastWrite = nullptr;
+            lastFirstByte = &event;
+        }
+        else if ((event.type == TracePacketComplete) && lastFirstByte)
+        {
+            ::fprintf(file, ",\n{\"name\":\"receive\",\"cat\":\"serialdv\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,"
+                "\"args\":{\"packetType\":%u,\"length\":%u}}",
+                (lastFirstByte->timestampNs - origin) / 1000.0, (event.timestampNs - lastFirstByte->timestampNs) / 1000.0,
+                event.packetType, event.length);
+            lastFirstByte = nullptr;
+        }
+    }
+
+    ::fprintf(file, "\n]}\n");
+    return ::fclose(file) == 0;
+}
+
+} // namespace SerialDV
@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRACERING_H_
+#define TRACERING_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "serialdv_export.h"
+
+namespace SerialDV
+{
+
+typedef enum
+{
+    TraceWrite,          //!< packet written to the device
+    TraceFirstByte,      //!< start byte of a response seen
+    TracePacketComplete, //!< response packet fully received
+    TraceRateChange,     //!< rate set on the device (value is the rate)
+    TraceTimeout,        //!< response timeout (value is the stage: 0 start byte, 1 header, 2 payload)
+    TraceResync,         //!< recovery step (value is the step: 1 drain, 2 soft reset, 3 reopen)
+    TraceError           //!< transport error
+} TraceEventType;
+
+#pragma pack(push, 1)
+struct TraceEvent
+{
+    uint64_t timestampNs; //!< steady clock
+    uint32_t value;       //!< event specific value
+    uint16_t length;      //!< packet length including header
+    uint8_t type;         //!< TraceEventType
+    uint8_t packetType;   //!< AMBE3000 packet type or 0xFF if not applicable
+};
+#pragma pack(pop)
+
+/** Fixed size ring of the most recent protocol events of one device. Recording is
+ * a few stores with no allocation or locking and is meant to stay enabled in
+ * production. The ring can be saved at any time to a binary file and converted
+ * to Chrome trace JSON (chrome://tracing, Perfetto) with the dvtrace tool.
+ */
+class SERIALDV_API TraceRing
+{
+public:
+    static const uint8_t NO_PACKET_TYPE = 0xFF;
+
+    /** Capacity is rounded up to a power of 2
+     */
+    explicit TraceRing(unsigned int capacity = 4096);
+
+    void record(TraceEventType type, uint8_t packetType = NO_PACKET_TYPE, unsigned int length = 0, uint32_t value = 0)
+    {
+        uint64_t index = m_index.load(std::memory_order_relaxed);
+        TraceEvent& event = m_events[index & m_mask];
+        event.timestampNs = now();
+        event.value = value;
+        event.length = length > 0xFFFF ? 0xFFFF : length;
+        event.type = type;
+        event.packetType = packetType;
+        m_index.store(index + 1, std::memory_order_release);
+    }
+
+    /** Record a packet given by its bytes
+     */
+    void recordPacket(TraceEventType type, const unsigned char *packet, unsigned int length)
+    {
+        record(type, length > 3 ? packet[3] : NO_PACKET_TYPE, length);
+    }
+
+    /** Events in chronological order. When taken while recording from another
+     * thread the oldest events may be overwritten during the copy.
+     */
+    void snapshot(std::vector<TraceEvent>& events) const;
+    void clear() { m_index.store(0); }
+    unsigned int getCapacity() const { return m_mask + 1; }
+    uint64_t getNbRecorded() const { return m_index.load(); }
+
+    bool save(const std::string& fileName) const;
+    static bool load(const std::string& fileName, std::vector<TraceEvent>& events);
+    static bool toChromeJson(const std::vector<TraceEvent>& events, const std::string& fileName, const std::string& processName = "serialDV");
+
+    static uint64_t now();
+    static const char *getEventName(TraceEventType type);
+
+private:
+    std::vector<TraceEvent> m_events;
+    unsigned int m_mask;
+    std::atomic<uint64_t> m_index;
+};
+
+} // namespace SerialDV
+
+#endif /* TRACERING_H_ */
@@ -0,0 +1,185 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <cstring>
+
+#include "transcoder.h"
+
+namespace SerialDV
+{
+
+const unsigned int Transcoder::NB_SLOTS;
+
+Transcoder::Transcoder(DVController& decoder, DVRate fromRate, DVController& encoder, DVRate toRate,
+        FrameCallback callback, int decodeGain, int encodeGain) :
+    m_decoder(decoder),
+    m_encoder(encoder),
+    m_fromRate(fromRate),
+    m_toRate(toRate),
+    m_callback(callback),
+    m_decodeGain(decodeGain),
+    m_encodeGain(encodeGain),
+    m_pushIndex(0),
+    m_decodeIndex(0),
+    m_encodeIndex(0),
+    m_running(false),
+    m_stop(false),
+    m_nbFrames(0),
+    m_nbFailed(0)
+{
+}
+
+Transcoder::~Transcoder()
+{
+    stop();
+}
+
+void Transcoder::start()
+{
+    if (m_running) {
+        return;
+    }
+
+    m_stop = false;
+    m_running = true;
+    m_decodeThread = std::thread(&Transcoder::decodeLoop, this);
+
+    if (&m_decoder != &m_encoder) {
+        m_encodeThread = std::thread(&Transcoder::encodeLoop, this);
+    }
+}
+
+void Transcoder::stop()
+{
+    if (!m_running) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_decodeCond.notify_one();
+    m_encodeCond.notify_one();
+    m_decodeThread.join();
+
+    if (m_encodeThread.joinable()) {
+        m_encodeThread.join();
+    }
+
+    m_running = false;
+}
+
+bool Transcoder::push(const unsigned char *mbeIn, unsigned char *mbeOut, void *userData)
+{
+    assert(mbeIn != 0);
+    assert(mbeOut != 0);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!m_running || m_stop || (m_pushIndex - m_encodeIndex == NB_SLOTS)) {
+            return false;
+        }
+
+        // the slot is free until the index is published
+        Slot& slot = m_slots[m_pushIndex % NB_SLOTS];
+        ::memcpy(slot.mbeIn, mbeIn, DVController::getNbMbeBytes(m_fromRate));
+        slot.mbeOut = mbeOut;
+        slot.userData = userData;
+        m_pushIndex++;
+    }
+
+    m_decodeCond.notify_one();
+    return true;
+}
+
+void Transcoder::decodeLoop()
+{
+    bool shared = &m_decoder == &m_encoder;
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        while (!m_stop && (m_decodeIndex == m_pushIndex)) {
+            m_decodeCond.wait(lock);
+        }
+
+        if (m_decodeIndex == m_pushIndex) {
+            break; // stopped and nothing left
+        }
+
+        Slot& slot = m_slots[m_decodeIndex % NB_SLOTS];
+        lock.unlock();
+        slot.decoded = m_decoder.decode(slot.audio, slot.mbeIn, m_fromRate, m_decodeGain);
+
+        if (shared) {
+            encodeSlot(slot);
+        }
+
+        lock.lock();
+        m_decodeIndex++;
+
+        if (shared) {
+            m_encodeIndex++;
+        } else {
+            m_encodeCond.notify_one();
+        }
+    }
+}
+
+void Transcoder::encodeLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        while (!m_stop && (m_encodeIndex == m_decodeIndex)) {
+            m_encodeCond.wait(lock);
+        }
+
+        if (m_encodeIndex == m_pushIndex) {
+            break; // stopped and nothing left
+        }
+
+        if (m_encodeIndex == m_decodeIndex)
+        {
+            m_encodeCond.wait(lock); // stopping: wait for the decode stage to finish
+            continue;
+        }
+
+        Slot& slot = m_slots[m_encodeIndex % NB_SLOTS];
+        lock.unlock();
+        encodeSlot(slot);
+        lock.lock();
+        m_encodeIndex++;
+    }
+}
+
+void Transcoder::encodeSlot(Slot& slot)
+{
+    bool ok = slot.decoded && m_encoder.encode(slot.audio, slot.mbeOut, m_toRate, m_encodeGain);
+    m_nbFrames++;
+    m_nbFailed += ok ? 0 : 1;
+
+    if (m_callback) {
+        m_callback(ok, slot.userData);
+    }
+}
+
+} // namespace SerialDV
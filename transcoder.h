@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRANSCODER_H_
+#define TRANSCODER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "serialdv_export.h"
+#include "dvcontroller.h"
+
+namespace SerialDV
+{
+
+/** Transcodes AMBE frames from one rate to another (ex: D-Star to DMR) with the decode stage
+ * on one device and the encode stage on another so that neither device switches rate.
+ *
+ * Each stage runs in its own thread: frame N+1 is decoded while frame N is encoded so the
+ * throughput is the one of the slowest stage and the latency of a frame is its decode plus
+ * its encode time. Decoded audio stays in the slot of the frame where the encoder reads it.
+ *
+ * The same controller can be given for both stages. Stages then run one after the other
+ * in a single thread.
+ */
+class SERIALDV_API Transcoder
+{
+public:
+    /** Called from the encode stage thread when a frame is transcoded or failed
+     */
+    typedef std::function<void(bool ok, void *userData)> FrameCallback;
+
+    static const unsigned int NB_SLOTS = 8U;   //!< frames in the transcoder at once
+
+    Transcoder(DVController& decoder, DVRate fromRate, DVController& encoder, DVRate toRate,
+        FrameCallback callback, int decodeGain = 0, int encodeGain = 0);
+    ~Transcoder();
+
+    void start();
+    /** Stop after the frames already pushed are transcoded
+     */
+    void stop();
+
+    /** Queue one frame. mbeIn is copied, mbeOut must remain valid until the callback is called.
+     * Returns false if the transcoder is full or not started.
+     */
+    bool push(const unsigned char *mbeIn, unsigned char *mbeOut, void *userData = nullptr);
+
+    unsigned long long getNbFrames() const { return m_nbFrames; }
+    unsigned long long getNbFailed() const { return m_nbFailed; }
+
+private:
+    struct Slot
+    {
+        unsigned char mbeIn[MBE_FRAME_MAX_LENGTH_BYTES_INTERNAL];
+        short audio[MBE_AUDIO_BLOCK_SIZE];
+        unsigned char *mbeOut;
+        void *userData;
+        bool decoded;
+    };
+
+    DVController& m_decoder;
+    DVController& m_encoder;
+    DVRate m_fromRate;
+    DVRate m_toRate;
+    FrameCallback m_callback;
+    int m_decodeGain;
+    int m_encodeGain;
+    Slot m_slots[NB_SLOTS];
+    unsigned int m_pushIndex;      //!< next slot to fill
+    unsigned int m_decodeIndex;    //!< next slot to decode
+    unsigned int m_encodeIndex;    //!< next slot to encode
+    std::mutex m_mutex;
+    std::condition_variable m_decodeCond;
+    std::condition_variable m_encodeCond;
+    std::thread m_decodeThread;
+    std::thread m_encodeThread;
+    bool m_running;
+    bool m_stop;
+    std::atomic<unsigned long long> m_nbFrames;  //!< updated by the encode stage thread
+    std::atomic<unsigned long long> m_nbFailed;
+
+    void decodeLoop();
+    void encodeLoop();
+    void encodeSlot(Slot& slot);
+};
+
+} // namespace SerialDV
+
+#endif /* TRANSCODER_H_ */
@@ -15,7 +15,6 @@
 ///////////////////////////////////////////////////////////////////////////////////
 
 #include <regex>
-#include <iostream>
 #include <algorithm>
 
 #ifdef __WINDOWS__
@@ -33,6 +32,9 @@
 #endif
 
 #include "udpdatacontroller.h"
+#include "logger.h"
+#include "tracering.h"
+#include "dvcontroller.h"
 
 namespace SerialDV
 {
@@ -73,7 +75,7 @@ bool UDPDataController::open(const std::string& ipAndPort, SERIAL_SPEED speed)
 
         if (m_port < 1024)
         {
-            std::cerr << "UDPDataController::open: not a valid port: " << m_port << std::endl;
+            SERIALDV_LOG(LogError, "UDPDataController::open: not a valid port: %d", m_port);
             return false;
         }
 
@@ -81,18 +83,18 @@ bool UDPDataController::open(const std::string& ipAndPort, SERIAL_SPEED speed)
 
         if (m_sockFd < 0)
         {
-            std::cerr << "UDPDataController::open: could not open socket at port: " << m_port << std::endl;
+            SERIALDV_LOG(LogError, "UDPDataController::open: could not open socket at port: %d", m_port);
             return false;
         }
 
         setSendAddress(m_ipAddress, m_port);
 
-        std::cout << "UDPDataController::open: ip: " << m_ipAddress << " port: " << m_port << std::endl;
+        SERIALDV_LOG(LogInfo, "UDPDataController::open: ip: %s port: %d", m_ipAddress.c_str(), m_port);
         return true;
     }
     else
     {
-        std::cerr << "UDPDataController::open: not a valid IP address and port: " << ipAndPort << std::endl;
+        SERIALDV_LOG(LogError, "UDPDataController::open: not a valid IP address and port: %s", ipAndPort.c_str());
         return false;
     }
 }
@@ -129,6 +131,43 @@ int UDPDataController::read(unsigned char* buffer, unsigned int lengthInBytes)
     }
 }
 
+int UDPDataController::readPacket(PacketView& packet, unsigned int timeoutUs)
+{
+    // one datagram is one packet: hand over the receive buffer
+    int size = timeout_recvfrom((char *) m_responseBuffer, sizeof(m_responseBuffer), m_ra, timeoutUs);
+    m_responseSize = 0;
+    m_responseIndex = 0;
+
+    if (size <= 0)
+    {
+        if (m_trace) {
+            m_trace->record(size < 0 ? TraceError : TraceTimeout);
+        }
+
+        return size < 0 ? -1 : 0;
+    }
+
+    if (m_trace) {
+        m_trace->record(TraceFirstByte);
+    }
+
+    if ((size < (int) DV3000_HEADER_LEN) || (m_responseBuffer[0] != DV3000_START_BYTE)
+     || ((int) (DV3000_HEADER_LEN + m_responseBuffer[1] * 256 + m_responseBuffer[2]) > size))
+    {
+        SERIALDV_LOG(LogError, "UDPDataController::readPacket: invalid packet of %d bytes", size);
+        return -1;
+    }
+
+    packet.data = m_responseBuffer;
+    packet.length = DV3000_HEADER_LEN + m_responseBuffer[1] * 256 + m_responseBuffer[2];
+
+    if (m_trace) {
+        m_trace->record(TracePacketComplete, m_responseBuffer[3], packet.length);
+    }
+
+    return packet.length;
+}
+
 int UDPDataController::write(const unsigned char* buffer, unsigned int lengthInBytes)
 {
 #ifdef __WINDOWS__
@@ -136,6 +175,7 @@ int UDPDataController::write(const unsigned char* buffer, unsigned int lengthInB
 #else
     int nbytes = sendto(m_sockFd, buffer, lengthInBytes, 0, (const sockaddr *) m_sa, sizeof(struct sockaddr_in));
 #endif
+    traceWrite(buffer, nbytes);
     return nbytes;
 }
 
@@ -153,9 +193,9 @@ void UDPDataController::openSocket(int port)
     if (m_sockFd < 0)
     {
 #ifdef __WINDOWS__
-        std::cerr << "UDPDataController::openSocket: error when creating the socket: " << WSAGetLastError() << std::endl;
+        SERIALDV_LOG(LogError, "UDPDataController::openSocket: error when creating the socket: %d", WSAGetLastError());
 #else
-        std::cerr << "UDPDataController::openSocket: error when creating the socket: " << strerror(errno) << std::endl;
+        SERIALDV_LOG(LogError, "UDPDataController::openSocket: error when creating the socket: %s", strerror(errno));
 #endif
         return;
     }
@@ -167,9 +207,9 @@ void UDPDataController::openSocket(int port)
     if (bind(m_sockFd, (struct sockaddr *) m_ra, sizeof(struct sockaddr_in)) < 0)
     {
 #ifdef __WINDOWS__
-        std::cerr << "UDPDataController::openSocket: error when binding the socket to port " << port << ": " <<  WSAGetLastError() << std::endl;
+        SERIALDV_LOG(LogError, "UDPDataController::openSocket: error when binding the socket to port %d: %d", port, WSAGetLastError());
 #else
-        std::cerr << "UDPDataController::openSocket: error when binding the socket to port " << port << ": " <<  strerror(errno) << std::endl;
+        SERIALDV_LOG(LogError, "UDPDataController::openSocket: error when binding the socket to port %d: %s", port, strerror(errno));
 #endif
         m_sockFd = -1;
     }
@@ -181,17 +221,17 @@ void UDPDataController::closeSocket()
     int rc = closesocket(m_sockFd);
 
     if (rc < 0) {
-        std::cerr << "UDPDataController::close: error when closing the socket: " << WSAGetLastError() << std::endl;
+        SERIALDV_LOG(LogError, "UDPDataController::close: error when closing the socket: %d", WSAGetLastError());
     } else {
-        std::cerr << "UDPDataController::close: socket closed" << std::endl;
+        SERIALDV_LOG(LogInfo, "UDPDataController::close: socket closed");
     }
 #else
     int rc = close(m_sockFd);
 
     if (rc < 0) {
-        std::cerr << "UDPDataController::close: error when closing the socket: " << strerror(errno) << std::endl;
+        SERIALDV_LOG(LogError, "UDPDataController::close: error when closing the socket: %s", strerror(errno));
     } else {
-        std::cerr << "UDPDataController::close: socket closed" << std::endl;
+        SERIALDV_LOG(LogInfo, "UDPDataController::close: socket closed");
     }
 #endif
 }
@@ -215,9 +255,9 @@ int UDPDataController::timeout_recvfrom(char *buf, int length, struct sockaddr_i
     if (select(m_sockFd + 1, &fds, nullptr, nullptr, &tv) < 0)
     {
 #ifdef __WINDOWS__
-        std::cerr << "UDPDataController::timeout_recvfrom: error from select: " << WSAGetLastError() << std::endl;
+        SERIALDV_LOG(LogError, "UDPDataController::timeout_recvfrom: error from select: %d", WSAGetLastError());
 #else
-        std::cerr << "UDPDataController::timeout_recvfrom: error from select: " << strerror(errno) << std::endl;
+        SERIALDV_LOG(LogError, "UDPDataController::timeout_recvfrom: error from select: %s", strerror(errno));
 #endif
         return 0;
     }
@@ -229,7 +269,7 @@ int UDPDataController::timeout_recvfrom(char *buf, int length, struct sockaddr_i
     }
     else
     {
-        std::cerr << "UDPDataController::timeout_recvfrom: no data" << std::endl;
+        SERIALDV_LOG(LogDebug, "UDPDataController::timeout_recvfrom: no data");
         return 0;
     }
 }
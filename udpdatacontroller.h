@@ -38,6 +38,10 @@ public:
 
     virtual void closeIt();
 
+    virtual int readPacket(PacketView& packet, unsigned int timeoutUs);
+    virtual int writePacket(const unsigned char* packet, unsigned int length) { return write(packet, length); }
+    virtual bool isDatagram() const { return true; }
+
 private:
     void openSocket(int port);
     void closeSocket();
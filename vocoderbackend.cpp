@@ -0,0 +1,64 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include "vocoderbackend.h"
+
+namespace SerialDV
+{
+
+DeviceBackend::DeviceBackend(DVController& controller, const std::string& name) :
+    m_controller(controller),
+    m_name(name)
+{
+}
+
+bool DeviceBackend::encode(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain)
+{
+    return m_controller.encode(audioFrame, mbeFrame, rate, gain);
+}
+
+bool DeviceBackend::decode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain)
+{
+    return m_controller.decode(audioFrame, mbeFrame, rate, gain);
+}
+
+PluginBackend::PluginBackend(const VocoderPlugin& plugin) :
+    m_plugin(plugin),
+    m_name(plugin.name ? plugin.name : "plugin")
+{
+}
+
+bool PluginBackend::canEncode(DVRate rate) const
+{
+    return m_plugin.encode && (!m_plugin.supportsRate || m_plugin.supportsRate(m_plugin.context, rate));
+}
+
+bool PluginBackend::canDecode(DVRate rate) const
+{
+    return m_plugin.decode && (!m_plugin.supportsRate || m_plugin.supportsRate(m_plugin.context, rate));
+}
+
+bool PluginBackend::encode(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain)
+{
+    return m_plugin.encode && m_plugin.encode(m_plugin.context, audioFrame, mbeFrame, rate, gain);
+}
+
+bool PluginBackend::decode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain)
+{
+    return m_plugin.decode && m_plugin.decode(m_plugin.context, audioFrame, mbeFrame, rate, gain);
+}
+
+} // namespace SerialDV
@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VOCODERBACKEND_H_
+#define VOCODERBACKEND_H_
+
+#include <string>
+
+#include "serialdv_export.h"
+#include "dvcontroller.h"
+
+namespace SerialDV
+{
+
+/** Something that encodes and/or decodes MBE frames: a device or a software codec.
+ * A backend is used by one thread at a time.
+ */
+class SERIALDV_API VocoderBackend
+{
+public:
+    virtual ~VocoderBackend() {}
+
+    virtual const std::string& getName() const = 0;
+    virtual bool isHardware() const = 0;
+    virtual bool canEncode(DVRate rate) const = 0;
+    virtual bool canDecode(DVRate rate) const = 0;
+    virtual bool encode(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain) = 0;
+    virtual bool decode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain) = 0;
+};
+
+/** Hardware backend over an open DVController that is not owned
+ */
+class SERIALDV_API DeviceBackend : public VocoderBackend
+{
+public:
+    DeviceBackend(DVController& controller, const std::string& name);
+
+    virtual const std::string& getName() const { return m_name; }
+    virtual bool isHardware() const { return true; }
+    virtual bool canEncode(DVRate rate) const { return DVController::getNbMbeBytes(rate) != 0; }
+    virtual bool canDecode(DVRate rate) const { return DVController::getNbMbeBytes(rate) != 0; }
+    virtual bool encode(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain);
+    virtual bool decode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain);
+
+private:
+    DVController& m_controller;
+    std::string m_name;
+};
+
+/** Software codec supplied by the application as plain functions so that it can come
+ * from any library. Functions that are not supported are left null (ex: encode of a
+ * decode only codec). supportsRate null means all rates.
+ */
+struct VocoderPlugin
+{
+    const char *name;
+    void *context;
+    bool (*supportsRate)(void *context, DVRate rate);
+    bool (*encode)(void *context, const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain);
+    bool (*decode)(void *context, short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain);
+};
+
+class SERIALDV_API PluginBackend : public VocoderBackend
+{
+public:
+    explicit PluginBackend(const VocoderPlugin& plugin);
+
+    virtual const std::string& getName() const { return m_name; }
+    virtual bool isHardware() const { return false; }
+    virtual bool canEncode(DVRate rate) const;
+    virtual bool canDecode(DVRate rate) const;
+    virtual bool encode(const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain);
+    virtual bool decode(short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain);
+
+private:
+    VocoderPlugin m_plugin;
+    std::string m_name;
+};
+
+} // namespace SerialDV
+
+#endif /* VOCODERBACKEND_H_ */
@@ -0,0 +1,244 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cassert>
+
+#include "vocoderpool.h"
+
+namespace SerialDV
+{
+
+VocoderPool::VocoderPool() :
+    m_nextStreamId(0),
+    m_spillThreshold(2),
+    m_nbSpilled(0)
+{
+}
+
+VocoderPool::~VocoderPool()
+{
+    for (unsigned int i = 0; i < m_backends.size(); i++)
+    {
+        delete m_backends[i]->backend;
+        delete m_backends[i];
+    }
+}
+
+int VocoderPool::addBackend(VocoderBackend *backend)
+{
+    assert(backend != 0);
+    Backend *entry = new Backend();
+    entry->backend = backend;
+    entry->load = 0;
+    entry->nbEncoded = 0;
+    entry->nbDecoded = 0;
+    entry->nbFailed = 0;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_backends.push_back(entry);
+    return m_backends.size() - 1;
+}
+
+int VocoderPool::addStream(VocoderAffinity affinity)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int streamId = m_nextStreamId++;
+    Stream& stream = m_streams[streamId];
+    stream.affinity = affinity;
+    stream.backend = -1;
+    stream.stats.backend = -1;
+    stream.stats.nbHardware = 0;
+    stream.stats.nbSoftware = 0;
+    return streamId;
+}
+
+void VocoderPool::removeStream(int streamId)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_streams.erase(streamId);
+}
+
+bool VocoderPool::encode(int streamId, const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain)
+{
+    return process(streamId, true, audioFrame, mbeFrame, nullptr, nullptr, rate, gain);
+}
+
+bool VocoderPool::decode(int streamId, short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain)
+{
+    return process(streamId, false, nullptr, nullptr, audioFrame, mbeFrame, rate, gain);
+}
+
+bool VocoderPool::isSaturated(const Backend *backend) const
+{
+    return backend->load > m_spillThreshold + 1; // one frame being processed, the others waiting
+}
+
+int VocoderPool::selectBackend(int streamId, bool encode, DVRate rate)
+{
+    Stream& stream = m_streams[streamId];
+    int bestHardware = -1;
+    int bestSoftware = -1;
+    bool hardwareIdle = false;
+
+    for (unsigned int i = 0; i < m_backends.size(); i++)
+    {
+        const Backend *backend = m_backends[i];
+
+        if (encode ? !backend->backend->canEncode(rate) : !backend->backend->canDecode(rate)) {
+            continue;
+        }
+
+        int& best = backend->backend->isHardware() ? bestHardware : bestSoftware;
+
+        if ((best < 0) || (backend->load < m_backends[best]->load)) {
+            best = i;
+        }
+
+        hardwareIdle = hardwareIdle || (backend->backend->isHardware() && (backend->load == 0));
+    }
+
+    int current = stream.backend;
+    bool currentUsable = (current >= 0) && (current < (int) m_backends.size())
+        && (encode ? m_backends[current]->backend->canEncode(rate) : m_backends[current]->backend->canDecode(rate));
+
+    if (stream.affinity == VocoderAffinityHardware)
+    {
+        currentUsable = currentUsable && m_backends[current]->backend->isHardware();
+        return currentUsable && !isSaturated(m_backends[current]) ? current : bestHardware;
+    }
+
+    if (stream.affinity == VocoderAffinitySpill)
+    {
+        if (currentUsable && m_backends[current]->backend->isHardware() && !isSaturated(m_backends[current])) {
+            return current;
+        }
+
+        if ((bestHardware >= 0) && !isSaturated(m_backends[bestHardware])) {
+            return bestHardware;
+        }
+
+        // all hardware saturated: stay on software until a device is idle
+        if (currentUsable && !m_backends[current]->backend->isHardware() && !hardwareIdle) {
+            return current;
+        }
+
+        return bestSoftware >= 0 ? bestSoftware : bestHardware;
+    }
+
+    if (currentUsable && !isSaturated(m_backends[current])) {
+        return current;
+    }
+
+    if ((bestHardware >= 0) && (bestSoftware >= 0)) {
+        return m_backends[bestSoftware]->load < m_backends[bestHardware]->load ? bestSoftware : bestHardware;
+    }
+
+    return bestHardware >= 0 ? bestHardware : bestSoftware;
+}
+
+bool VocoderPool::process(int streamId, bool encode, const short *audioIn, unsigned char *mbeOut,
+        short *audioOut, const unsigned char *mbeIn, DVRate rate, int gain)
+{
+    Backend *backend;
+    bool hardware;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_streams.find(streamId) == m_streams.end()) {
+            return false;
+        }
+
+        int index = selectBackend(streamId, encode, rate);
+
+        if (index < 0) {
+            return false;
+        }
+
+        backend = m_backends[index];
+        hardware = backend->backend->isHardware();
+        backend->load++;
+        Stream& stream = m_streams[streamId];
+        stream.backend = index;
+        stream.stats.backend = index;
+
+        if (!hardware && (stream.affinity == VocoderAffinitySpill)) {
+            m_nbSpilled++;
+        }
+    }
+
+    bool ok;
+
+    {
+        std::lock_guard<std::mutex> lock(backend->mutex);
+        ok = encode ?
+            backend->backend->encode(audioIn, mbeOut, rate, gain) :
+            backend->backend->decode(audioOut, mbeIn, rate, gain);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    backend->load--;
+    backend->nbEncoded += encode && ok ? 1 : 0;
+    backend->nbDecoded += !encode && ok ? 1 : 0;
+    backend->nbFailed += ok ? 0 : 1;
+    std::map<int, Stream>::iterator it = m_streams.find(streamId);
+
+    if (it != m_streams.end())
+    {
+        it->second.stats.nbHardware += hardware ? 1 : 0;
+        it->second.stats.nbSoftware += hardware ? 0 : 1;
+    }
+
+    return ok;
+}
+
+std::vector<VocoderBackendStats> VocoderPool::getBackendStats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<VocoderBackendStats> stats(m_backends.size());
+
+    for (unsigned int i = 0; i < m_backends.size(); i++)
+    {
+        stats[i].name = m_backends[i]->backend->getName();
+        stats[i].hardware = m_backends[i]->backend->isHardware();
+        stats[i].load = m_backends[i]->load;
+        stats[i].nbEncoded = m_backends[i]->nbEncoded;
+        stats[i].nbDecoded = m_backends[i]->nbDecoded;
+        stats[i].nbFailed = m_backends[i]->nbFailed;
+    }
+
+    return stats;
+}
+
+bool VocoderPool::getStreamStats(int streamId, VocoderStreamStats& stats)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<int, Stream>::const_iterator it = m_streams.find(streamId);
+
+    if (it == m_streams.end()) {
+        return false;
+    }
+
+    stats = it->second.stats;
+    return true;
+}
+
+unsigned long long VocoderPool::getNbSpilled()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nbSpilled;
+}
+
+} // namespace SerialDV
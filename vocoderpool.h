@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VOCODERPOOL_H_
+#define VOCODERPOOL_H_
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "serialdv_export.h"
+#include "vocoderbackend.h"
+
+namespace SerialDV
+{
+
+typedef enum
+{
+    VocoderAffinityHardware,  //!< hardware backends only
+    VocoderAffinitySpill,     //!< hardware backends, software ones while all hardware is saturated
+    VocoderAffinityAny        //!< least loaded backend
+} VocoderAffinity;
+
+struct VocoderBackendStats
+{
+    std::string name;
+    bool hardware;
+    unsigned int load;                //!< frames being processed or waiting
+    unsigned long long nbEncoded;
+    unsigned long long nbDecoded;
+    unsigned long long nbFailed;
+};
+
+struct VocoderStreamStats
+{
+    int backend;                      //!< index of the backend the stream is bound to or -1
+    unsigned long long nbHardware;    //!< frames processed by hardware backends
+    unsigned long long nbSoftware;    //!< frames processed by software backends
+};
+
+/** Shares a set of vocoder backends between streams. encode() and decode() can be called
+ * concurrently from the threads of the streams: each backend is used by one of them at a
+ * time and the others wait for it.
+ *
+ * A stream stays on the backend it was given as long as this backend is not saturated so
+ * that codec state is kept. A hardware backend is saturated when more than the spill
+ * threshold frames wait for it. Streams allowing it are then moved to a software backend
+ * and go back to hardware as soon as a hardware backend is idle.
+ */
+class SERIALDV_API VocoderPool
+{
+public:
+    VocoderPool();
+    ~VocoderPool();
+
+    /** Add a backend that is then owned by the pool. Returns its index
+     */
+    int addBackend(VocoderBackend *backend);
+    void setSpillThreshold(unsigned int nbWaiting) { m_spillThreshold = nbWaiting; }
+
+    int addStream(VocoderAffinity affinity = VocoderAffinitySpill);
+    void removeStream(int streamId);
+
+    bool encode(int streamId, const short *audioFrame, unsigned char *mbeFrame, DVRate rate, int gain = 0);
+    bool decode(int streamId, short *audioFrame, const unsigned char *mbeFrame, DVRate rate, int gain = 0);
+
+    std::vector<VocoderBackendStats> getBackendStats();
+    bool getStreamStats(int streamId, VocoderStreamStats& stats);
+    unsigned long long getNbSpilled();   //!< frames sent to software because hardware was saturated
+
+private:
+    struct Backend
+    {
+        VocoderBackend *backend;
+        std::mutex mutex;             //!< held while the backend processes a frame
+        unsigned int load;
+        unsigned long long nbEncoded;
+        unsigned long long nbDecoded;
+        unsigned long long nbFailed;
+    };
+
+    struct Stream
+    {
+        VocoderAffinity affinity;
+        int backend;
+        VocoderStreamStats stats;
+    };
+
+    std::mutex m_mutex;               //!< protects everything but the backends processing
+    std::vector<Backend*> m_backends;
+    std::map<int, Stream> m_streams;
+    int m_nextStreamId;
+    unsigned int m_spillThreshold;
+    unsigned long long m_nbSpilled;
+
+    int selectBackend(int streamId, bool encode, DVRate rate);
+    bool isSaturated(const Backend *backend) const;
+    bool process(int streamId, bool encode, const short *audioIn, unsigned char *mbeOut,
+        short *audioOut, const unsigned char *mbeIn, DVRate rate, int gain);
+};
+
+} // namespace SerialDV
+
+#endif /* VOCODERPOOL_H_ */